@@ -24,6 +24,9 @@ public class BlenderViewportControls : ModuleRules
 			new string[]
 			{
 				"Core",
+				"CoreUObject",
+				"Engine",
+				"EditorSubsystem",
 			}
 			);
 			
@@ -31,15 +34,15 @@ public class BlenderViewportControls : ModuleRules
 		PrivateDependencyModuleNames.AddRange(
 			new string[]
 			{
-				"CoreUObject",
-				"Engine",
+				"RenderCore",
 				"Slate",
 				"SlateCore",
 				"InputCore",
 				"UnrealEd",
 				"LevelEditor",
 				"ViewportInteraction",
-				"EditorFramework"
+				"EditorFramework",
+				"Landscape"
 			}
 			);
 		
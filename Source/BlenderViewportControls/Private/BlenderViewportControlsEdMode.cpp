@@ -1,20 +1,153 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "BlenderViewportControlsEdMode.h"
+#include "BlenderViewportControls.h"
 #include "BlenderViewportControls_Tools.h"
 #include "BlenderViewportControls_HelperFunctions.h"
 #include "Editor/EditorEngine.h"
 #include "DrawDebugHelpers.h"
 #include "Engine/Selection.h"
+#include "LevelEditorViewport.h"
+#include "Misc/Paths.h"
 
 const FEditorModeID FBlenderViewportControlsEdMode::EM_BlenderViewportControlsEdModeId = TEXT("EM_BlenderViewportControlsEdMode");
 
 extern UNREALED_API UEditorEngine* GEditor;
 
+DECLARE_CYCLE_STAT(TEXT("DrawHUD"), STAT_BlenderViewportControls_DrawHUD, STATGROUP_BlenderViewportControls);
+
+static TAutoConsoleVariable<int32> CVarArrayDuplicateCount(
+	TEXT("BlenderViewportControls.ArrayDuplicateCount"),
+	10,
+	TEXT("Number of copies Ctrl + Shift + R creates when repeating the last duplicate."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarDropTraceDistance(
+	TEXT("BlenderViewportControls.DropTraceDistance"),
+	100000.f,
+	TEXT("How far drop to surface looks for a surface, in cm."),
+	ECVF_Default);
+
+static FString GetRecordingFilename(const TArray<FString>& InArgs)
+{
+	return InArgs.Num() > 0 ? InArgs[0] : FPaths::ProjectSavedDir() / TEXT("BlenderViewportControls") / TEXT("Session.bvcrec");
+}
+
+static FBlenderViewportControlsEdMode* GetEdModeForCommand()
+{
+	FBlenderViewportControlsEdMode* EdMode = ToolHelperFunctions::GetEdMode();
+	if (!EdMode || !GCurrentLevelEditingViewportClient)
+	{
+		UE_LOG(LogBlenderTool, Warning, TEXT("The BlenderViewportControls mode has to be active in a level viewport"));
+		return nullptr;
+	}
+
+	return EdMode;
+}
+
+static FAutoConsoleCommand StartRecordingCommand(
+	TEXT("BlenderViewportControls.StartRecording"),
+	TEXT("Records the input of the current level viewport until BlenderViewportControls.StopRecording."),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		if (FBlenderViewportControlsEdMode* EdMode = GetEdModeForCommand())
+		{
+			EdMode->StartRecording();
+		}
+	}));
+
+static FAutoConsoleCommand StopRecordingCommand(
+	TEXT("BlenderViewportControls.StopRecording"),
+	TEXT("Writes the recording to the given file, Saved/BlenderViewportControls/Session.bvcrec by default."),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		if (FBlenderViewportControlsEdMode* EdMode = GetEdModeForCommand())
+		{
+			EdMode->StopRecording(GetRecordingFilename(Args));
+		}
+	}));
+
+static FAutoConsoleCommand DropToSurfaceCommand(
+	TEXT("BlenderViewportControls.DropToSurface"),
+	TEXT("Drops the selected actors onto the surface below them. Optional arguments: the direction (X, -X, Y, -Y, Z, -Z, default -Z) and 1 to align to the surface normal."),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		FBlenderViewportControlsEdMode* EdMode = GetEdModeForCommand();
+		if (!EdMode)
+		{
+			return;
+		}
+
+		FVector Direction = -FVector::UpVector;
+		if (Args.Num() > 0)
+		{
+			const FString Axis = Args[0].Replace(TEXT("-"), TEXT("")).ToUpper();
+			const double Sign = Args[0].StartsWith(TEXT("-")) ? -1.0 : 1.0;
+			if (Axis == TEXT("X"))
+			{
+				Direction = FVector::ForwardVector * Sign;
+			}
+			else if (Axis == TEXT("Y"))
+			{
+				Direction = FVector::RightVector * Sign;
+			}
+			else if (Axis == TEXT("Z"))
+			{
+				Direction = FVector::UpVector * Sign;
+			}
+			else
+			{
+				UE_LOG(LogBlenderTool, Warning, TEXT("Unknown drop direction %s, use X, -X, Y, -Y, Z or -Z"), *Args[0]);
+				return;
+			}
+		}
+
+		const bool bAlignToNormal = Args.Num() > 1 && FCString::Atoi(*Args[1]) != 0;
+		EdMode->DropSelectionToSurface(Direction, bAlignToNormal);
+	}));
+
+static FAutoConsoleCommand RandomizeCommand(
+	TEXT("BlenderViewportControls.Randomize"),
+	TEXT("Randomizes the selected actors: Randomize <Location cm> <Rotation degrees> <Scale> [Seed]. Every range applies to all axes, the scale is uniform."),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		FBlenderViewportControlsEdMode* EdMode = GetEdModeForCommand();
+		if (!EdMode)
+		{
+			return;
+		}
+
+		if (Args.Num() < 3)
+		{
+			UE_LOG(LogBlenderTool, Warning, TEXT("Usage: BlenderViewportControls.Randomize <Location cm> <Rotation degrees> <Scale> [Seed]"));
+			return;
+		}
+
+		const double LocationRange = FCString::Atod(*Args[0]);
+		const double RotationRange = FCString::Atod(*Args[1]);
+		const double ScaleRange = FCString::Atod(*Args[2]);
+		const int32 Seed = Args.Num() > 3 ? FCString::Atoi(*Args[3]) : 0;
+
+		EdMode->RandomizeSelection(FVector(LocationRange), FRotator(RotationRange), FVector(ScaleRange), true, Seed);
+	}));
+
+static FAutoConsoleCommand ReplayCommand(
+	TEXT("BlenderViewportControls.Replay"),
+	TEXT("Replays a recording in the current level viewport and writes frame timings and final transforms to a csv next to it."),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		if (FBlenderViewportControlsEdMode* EdMode = GetEdModeForCommand())
+		{
+			EdMode->StartReplay(GetRecordingFilename(Args));
+		}
+	}));
+
 /** FEdMode: Called when user Enters the Mode */
 void FBlenderViewportControlsEdMode::Enter()
 {
 	FEdMode::Enter();
+
+	SelectionTool = MakeUnique<FViewportSelectionTool>();
 	
 	// If we lose our selection, set the SharedPtr to null to get rid of the active tool
 	SelectionChangedHandle = USelection::SelectionChangedEvent.AddLambda([&](UObject* Object)
@@ -25,6 +158,12 @@ void FBlenderViewportControlsEdMode::Enter()
 		}
 		
 		ActiveToolMode = nullptr;
+
+		// Repeating a duplicate only makes sense as long as the duplicates are still what the user is working on
+		if (!bIsChangingSelection)
+		{
+			RepeatDuplicateRecord.Reset();
+		}
 	});
 }
 
@@ -34,6 +173,20 @@ void FBlenderViewportControlsEdMode::Exit()
 	// Unbind delegates
 	USelection::SelectionChangedEvent.Remove(SelectionChangedHandle);
 
+	SelectionTool.Reset();
+	ToolHelperFunctions::ResetViewportProjections();
+
+	// A session can't outlive the mode
+	if (SessionRecorder.IsRecording())
+	{
+		StopRecording(GetRecordingFilename(TArray<FString>()));
+	}
+
+	if (SessionReplayer.IsReplaying())
+	{
+		SessionReplayer.Finish();
+	}
+
 	// Call base Exit method to ensure proper cleanup
 	FEdMode::Exit();
 }
@@ -41,19 +194,48 @@ void FBlenderViewportControlsEdMode::Exit()
 /** FEdMode: Called every frame as long as the Mode is active */
 void FBlenderViewportControlsEdMode::Tick(FEditorViewportClient* InViewportClient, float DeltaTime)
 {
-	if (ActiveToolMode)
+	if (SessionReplayer.IsReplaying())
+	{
+		if (SessionReplayer.IsReplayingIn(InViewportClient))
+		{
+			ReplayFrame(InViewportClient);
+		}
+		return;
+	}
+
+	if (SessionRecorder.IsRecording())
+	{
+		SessionRecorder.RecordFrame(InViewportClient);
+	}
+
+	// Every viewport ticks the mode, the tool only updates in the viewport it follows the cursor in
+	if (ActiveToolMode && ActiveToolMode->GetViewportClient() == InViewportClient)
 	{
 		// Update the active tool
-		ActiveToolMode->ToolUpdate();
+		ActiveToolMode->ToolTick();
 	}
+
+	SelectionTool->Tick(InViewportClient);
 }
 
 void FBlenderViewportControlsEdMode::DrawHUD(FEditorViewportClient* ViewportClient, FViewport* Viewport, const FSceneView* View, FCanvas* Canvas)
 {
-	if (ActiveToolMode)
+	SCOPE_CYCLE_COUNTER(STAT_BlenderViewportControls_DrawHUD);
+
+	if (ActiveToolMode && ActiveToolMode->GetViewportClient() == ViewportClient)
 	{
 		// Let Tools draw their own viewport HUD visualizations
 		ActiveToolMode->DrawHUD(ViewportClient, Viewport, View, Canvas);
+
+		if (FToolPerfStats::IsEnabled())
+		{
+			ActiveToolMode->DrawPerfOverlay(Canvas);
+		}
+	}
+
+	if (SelectionTool->IsActiveIn(ViewportClient))
+	{
+		SelectionTool->DrawHUD(Canvas);
 	}
 }
 
@@ -61,9 +243,49 @@ void FBlenderViewportControlsEdMode::DrawHUD(FEditorViewportClient* ViewportClie
 bool FBlenderViewportControlsEdMode::InputKey(FEditorViewportClient* InViewportClient, FViewport* InViewport, FKey InKey, EInputEvent InEvent)
 {
 	// Modifier key states
-	const bool bAltDown = InViewportClient->IsAltPressed();
-	const bool bShiftDown = InViewportClient->IsShiftPressed();
-	const bool bControlDown = InViewportClient->IsCtrlPressed();
+	// Real input would interfere with a replay, the replayer sends its recorded keys through here itself
+	if (SessionReplayer.IsReplaying() && !bIsReplayingInput)
+	{
+		return true;
+	}
+
+	if (SessionRecorder.IsRecording())
+	{
+		SessionRecorder.RecordKey(InViewportClient, InKey, InEvent);
+	}
+
+	const FToolInputState InputState = FToolInputState::Get(InViewportClient);
+	const bool bAltDown = InputState.bAltDown;
+	const bool bShiftDown = InputState.bShiftDown;
+	const bool bControlDown = InputState.bCtrlDown;
+
+	// Keys go to the viewport that has focus, the tool continues there
+	if (IsOperationInProgress() && !bIsReplayingInput)
+	{
+		ActiveToolMode->SetViewportClient(InViewportClient);
+	}
+
+	/** Box and Circle Selection **/
+	// A running selection gets the mouse buttons first, B and C only start one outside of an operation
+	if (SelectionTool->InputKey(InViewportClient, InKey, InEvent))
+	{
+		return true;
+	}
+
+	if (!IsOperationInProgress() && !SelectionTool->IsActive() && InEvent == IE_Pressed && !bControlDown && !bAltDown && !bShiftDown && !InViewportClient->IsFlightCameraActive())
+	{
+		if (InKey == EKeys::B)
+		{
+			SelectionTool->Begin(InViewportClient, EViewportSelectionMode::Box);
+			return true;
+		}
+
+		if (InKey == EKeys::C)
+		{
+			SelectionTool->Begin(InViewportClient, EViewportSelectionMode::Circle);
+			return true;
+		}
+	}
 
 	// Accept Operation
 	if (InKey == EKeys::LeftMouseButton && InEvent != IE_Released)
@@ -85,9 +307,36 @@ bool FBlenderViewportControlsEdMode::InputKey(FEditorViewportClient* InViewportC
 		}
 	}
 
+	/** Numeric Input **/
+	// Typed values replace the cursor input, Enter accepts the operation like a left click
+	if (IsOperationInProgress() && InEvent != IE_Released)
+	{
+		if (InKey == EKeys::Enter)
+		{
+			FinishActiveOperation(true);
+			return true;
+		}
+
+		if (ActiveToolMode->HandleNumericInput(InKey))
+		{
+			return true;
+		}
+	}
+
+	/** Repeat Last Duplicate **/
+	// Shift + R repeats the last duplicate once, Ctrl + Shift + R creates a whole array of copies
+	if (!IsOperationInProgress() && bShiftDown && RepeatDuplicateRecord.HasDelta())
+	{
+		if (InKey == EKeys::R && InEvent != IE_Released)
+		{
+			RepeatLastDuplicate(bControlDown ? CVarArrayDuplicateCount.GetValueOnGameThread() : 1);
+			return true;
+		}
+	}
+
 	/** Transform Modes **/
-	// If alt is down G,R,S are instead resetting transforms
-	if (!bAltDown && !InViewportClient->IsFlightCameraActive() && HasActiveSelection())
+	// If alt is down G,R,S are instead resetting transforms. A running box or circle selection has to be finished first
+	if (!bAltDown && !InViewportClient->IsFlightCameraActive() && HasActiveSelection() && !SelectionTool->IsActive())
 	{
 		// Enter Actor Move Mode
 		if (InKey == EKeys::G && InEvent != IE_Released)
@@ -137,6 +386,46 @@ bool FBlenderViewportControlsEdMode::InputKey(FEditorViewportClient* InViewportC
 		}
 	}
 
+	/** Pivot Mode **/
+	// Period switches between the median point and individual origins. While a tool is active it is part of the typed value instead
+	if (InKey == EKeys::Period && InEvent == IE_Pressed && !bControlDown && !bAltDown && !IsOperationInProgress())
+	{
+		const bool bIndividualOrigins = FBlenderToolMode::GetPivotMode() != EToolPivotMode::IndividualOrigins;
+		FBlenderToolMode::SetPivotMode(bIndividualOrigins ? EToolPivotMode::IndividualOrigins : EToolPivotMode::Median);
+		UE_LOG(LogBlenderTool, Log, TEXT("Pivot: %s"), bIndividualOrigins ? TEXT("Individual Origins") : TEXT("Median Point"));
+
+		return true;
+	}
+
+	/** Proportional Editing **/
+	// O toggles proportional editing, it can be changed while an operation is running and persists for the next ones
+	if (InKey == EKeys::O && InEvent == IE_Pressed && !bControlDown && !bAltDown && (IsOperationInProgress() || HasActiveSelection()))
+	{
+		FBlenderToolMode::SetProportionalEditing(!FBlenderToolMode::IsProportionalEditing());
+		if (IsOperationInProgress())
+		{
+			ActiveToolMode->UpdateProportionalEditing();
+		}
+
+		return true;
+	}
+
+	// Scrolling changes the proportional editing radius
+	if (IsOperationInProgress() && !bControlDown && FBlenderToolMode::IsProportionalEditing())
+	{
+		if (InKey == EKeys::MouseScrollUp)
+		{
+			ActiveToolMode->AddProportionalRadius(1.f);
+			return true;
+		}
+
+		if (InKey == EKeys::MouseScrollDown)
+		{
+			ActiveToolMode->AddProportionalRadius(-1.f);
+			return true;
+		}
+	}
+
 	/**  Axis Constraints **/
 	// Only check these binds when we are in an active tool mode so we don't consume default editor input.
 	// E.g Ctrl + Z would not work without this.
@@ -148,6 +437,7 @@ bool FBlenderViewportControlsEdMode::InputKey(FEditorViewportClient* InViewportC
 		if (InKey == EKeys::X && InEvent != IE_Released)
 		{
 			ActiveToolMode->SetAxisLock(X, IsDualAxisLock);
+			ActiveToolMode->RefreshNumericInput();
 			return true;
 		}
 
@@ -155,6 +445,7 @@ bool FBlenderViewportControlsEdMode::InputKey(FEditorViewportClient* InViewportC
 		if (InKey == EKeys::Y && InEvent != IE_Released)
 		{
 			ActiveToolMode->SetAxisLock(Y, IsDualAxisLock);
+			ActiveToolMode->RefreshNumericInput();
 			return true;
 		}
 
@@ -162,6 +453,7 @@ bool FBlenderViewportControlsEdMode::InputKey(FEditorViewportClient* InViewportC
 		if (InKey == EKeys::Z && InEvent != IE_Released)
 		{
 			ActiveToolMode->SetAxisLock(Z, IsDualAxisLock);
+			ActiveToolMode->RefreshNumericInput();
 			return true;
 		}
 	}
@@ -173,25 +465,33 @@ bool FBlenderViewportControlsEdMode::InputKey(FEditorViewportClient* InViewportC
 		// Reset Actor Location
 		if (InKey == EKeys::G && InEvent != IE_Released && bAltDown)
 		{
-			ResetSpecificActorTransform([](AActor* Actor) { Actor->SetActorLocation(FVector::ZeroVector); });
+			ResetSpecificActorTransform(ETransformComponents::Location);
 			return true;
 		}
 
 		// Reset Actor Rotation
 		if (InKey == EKeys::R && InEvent != IE_Released && bAltDown)
 		{
-			ResetSpecificActorTransform([](AActor* Actor) { Actor->SetActorRotation(FRotator::ZeroRotator); });
+			ResetSpecificActorTransform(ETransformComponents::Rotation);
 			return true;
 		}
 
 		// Reset Actor Scale
 		if (InKey == EKeys::S && InEvent != IE_Released && bAltDown)
 		{
-			ResetSpecificActorTransform([](AActor* Actor) { Actor->SetActorScale3D(FVector::OneVector); });
+			ResetSpecificActorTransform(ETransformComponents::Scale);
 			return true;
 		}
 	}
 
+	/** Drop to Surface */
+	// End drops the selection straight down, Ctrl + End also aligns it to the surface normal
+	if (!IsOperationInProgress() && InKey == EKeys::End && InEvent == IE_Pressed && !bAltDown)
+	{
+		DropSelectionToSurface(-FVector::UpVector, bControlDown);
+		return true;
+	}
+
 	/** Duplicate Selection */
 	if (!IsOperationInProgress())
 	{
@@ -205,7 +505,90 @@ bool FBlenderViewportControlsEdMode::InputKey(FEditorViewportClient* InViewportC
 	return false;
 }
 
-void FBlenderViewportControlsEdMode::ResetSpecificActorTransform(void(*DoReset)(AActor*))
+/** FEdMode: Called when the mouse moves over a viewport */
+bool FBlenderViewportControlsEdMode::MouseMove(FEditorViewportClient* InViewportClient, FViewport* InViewport, int32 InX, int32 InY)
+{
+	// Moving the cursor into another viewport (e.g. in a quad view layout) continues the operation in that viewport
+	if (IsOperationInProgress() && !SessionReplayer.IsReplaying())
+	{
+		ActiveToolMode->SetViewportClient(InViewportClient);
+	}
+
+	return false;
+}
+
+void FBlenderViewportControlsEdMode::StartRecording()
+{
+	if (SessionReplayer.IsReplaying())
+	{
+		return;
+	}
+
+	// Recording in the middle of an operation would miss the key that started it
+	if (IsOperationInProgress())
+	{
+		FinishActiveOperation(false);
+	}
+
+	SessionRecorder.Start(GCurrentLevelEditingViewportClient);
+}
+
+void FBlenderViewportControlsEdMode::StopRecording(const FString& InFilename)
+{
+	if (SessionRecorder.IsRecording())
+	{
+		SessionRecorder.Stop(InFilename);
+	}
+}
+
+void FBlenderViewportControlsEdMode::StartReplay(const FString& InFilename)
+{
+	if (SessionRecorder.IsRecording() || SessionReplayer.IsReplaying())
+	{
+		return;
+	}
+
+	if (IsOperationInProgress())
+	{
+		FinishActiveOperation(false);
+	}
+
+	SessionReplayer.Start(InFilename, GCurrentLevelEditingViewportClient);
+}
+
+void FBlenderViewportControlsEdMode::ReplayFrame(FEditorViewportClient* InViewportClient)
+{
+	TArray<FKey> Keys;
+	TArray<EInputEvent> Events;
+	if (!SessionReplayer.BeginFrame(Keys, Events))
+	{
+		if (IsOperationInProgress())
+		{
+			FinishActiveOperation(false);
+		}
+
+		SessionReplayer.Finish();
+		return;
+	}
+
+	const double StartSeconds = FPlatformTime::Seconds();
+
+	bIsReplayingInput = true;
+	for (int32 KeyIndex = 0; KeyIndex < Keys.Num(); ++KeyIndex)
+	{
+		InputKey(InViewportClient, InViewportClient->Viewport, Keys[KeyIndex], Events[KeyIndex]);
+	}
+	bIsReplayingInput = false;
+
+	if (ActiveToolMode)
+	{
+		ActiveToolMode->ToolTick();
+	}
+
+	SessionReplayer.EndFrame(FPlatformTime::Seconds() - StartSeconds);
+}
+
+void FBlenderViewportControlsEdMode::ResetSpecificActorTransform(ETransformComponents InComponents)
 {
 	// The selection transform resets should only work when we are not in an active operation and we have something selected
 	if (IsOperationInProgress() || !HasActiveSelection())
@@ -213,19 +596,111 @@ void FBlenderViewportControlsEdMode::ResetSpecificActorTransform(void(*DoReset)(
 		return;
 	}
 
+	// Resets go through the same batched write back as the tools, the reset values are constants so the transforms aren't captured
+	FGroupTransform ResetGroup;
+	ResetGroup.AddResetChildren(ToolHelperFunctions::GetSelectedLevelActors());
+
 	// Start Transaction
 	GEditor->BeginTransaction(FText::FromString(TEXT("BlenderTool: ResetTransform")));
-	USelection* SelectedActors = GEditor->GetSelectedActors();
-	for (FSelectionIterator Iter(*SelectedActors); Iter; ++Iter)
+	FToolDragSession ResetSession(GetWorld());
+	ResetGroup.ResetTransforms(InComponents);
+	ResetSession.Commit(ResetGroup.GetAllChildActors());
+
+	// End Transaction
+	GEditor->EndTransaction();
+}
+
+void FBlenderViewportControlsEdMode::DropSelectionToSurface(const FVector& InDirection, bool bAlignToNormal)
+{
+	if (IsOperationInProgress() || !HasActiveSelection())
+	{
+		return;
+	}
+
+	const TArray<AActor*> SelectedActors = ToolHelperFunctions::GetSelectedLevelActors();
+	const FVector TraceOffset = InDirection.GetSafeNormal() * CVarDropTraceDistance.GetValueOnGameThread();
+
+	TArray<FVector> TraceStarts;
+	TArray<FVector> TraceEnds;
+	TraceStarts.Reserve(SelectedActors.Num());
+	TraceEnds.Reserve(SelectedActors.Num());
+	for (const AActor* Actor : SelectedActors)
+	{
+		TraceStarts.Add(Actor->GetActorLocation());
+		TraceEnds.Add(Actor->GetActorLocation() + TraceOffset);
+	}
+
+	// The selection can't be its own surface, neither can anything attached to it
+	TArray<FHitResult> Hits;
+	ToolHelperFunctions::LineTraceBatch(GetWorld(), TraceStarts, TraceEnds, ToolHelperFunctions::GetActorsWithAttachedActors(SelectedActors), Hits);
+
+	// Only the actors that hit something are part of the operation
+	const float SnapOffset = FBlenderToolMode::GetSnapOffset();
+	FGroupTransform DropGroup;
+	TArray<FTransform> DropTransforms;
+	TArray<FQuat> HitRotations;
+	TArray<FVector> HitNormals;
+	for (int32 ActorIndex = 0; ActorIndex < SelectedActors.Num(); ++ActorIndex)
+	{
+		const FHitResult& Hit = Hits[ActorIndex];
+		if (!Hit.bBlockingHit)
+		{
+			continue;
+		}
+
+		AActor* Actor = SelectedActors[ActorIndex];
+		FTransform& DropTransform = DropTransforms.Add_GetRef(Actor->GetActorTransform());
+		DropTransform.SetLocation(Hit.ImpactPoint + Hit.ImpactNormal * SnapOffset);
+		HitRotations.Add(DropTransform.GetRotation());
+		HitNormals.Add(Hit.ImpactNormal);
+
+		DropGroup.AddChild(Actor);
+	}
+
+	if (bAlignToNormal)
 	{
-		if (AActor* LevelActor = Cast<AActor>(*Iter))
+		TArray<FQuat> AlignedRotations;
+		ToolHelperFunctions::FindActorAlignmentRotations(HitRotations, FVector(0.f, 0.f, 1.f), HitNormals, AlignedRotations);
+		for (int32 DropIndex = 0; DropIndex < DropTransforms.Num(); ++DropIndex)
 		{
-			LevelActor->Modify();
-			DoReset(LevelActor);
+			DropTransforms[DropIndex].SetRotation(AlignedRotations[DropIndex]);
 		}
 	}
 
-	// End Transaction
+	UE_LOG(LogBlenderTool, Log, TEXT("Drop to surface: %d of %d actors hit a surface"), DropTransforms.Num(), SelectedActors.Num());
+	if (DropTransforms.Num() == 0)
+	{
+		return;
+	}
+
+	GEditor->BeginTransaction(FText::FromString(TEXT("BlenderTool: DropToSurface")));
+	FToolDragSession DropSession(GetWorld());
+	DropGroup.SetTransforms(DropTransforms, bAlignToNormal ? ETransformComponents::Location | ETransformComponents::Rotation : ETransformComponents::Location);
+	DropSession.Commit(DropGroup.GetAllChildActors());
+	GEditor->EndTransaction();
+}
+
+void FBlenderViewportControlsEdMode::RandomizeSelection(const FVector& InLocationRange, const FRotator& InRotationRange, const FVector& InScaleRange, bool bUniformScale, int32 InSeed)
+{
+	if (IsOperationInProgress() || !HasActiveSelection())
+	{
+		return;
+	}
+
+	const TArray<AActor*> SelectedActors = ToolHelperFunctions::GetSelectedLevelActors();
+	FGroupTransform RandomizeGroup;
+	for (AActor* LevelActor : SelectedActors)
+	{
+		RandomizeGroup.AddChild(LevelActor);
+	}
+
+	// The random offsets are applied to the records of the children
+	RandomizeGroup.FinishSetup(GetWorld(), ToolHelperFunctions::GetAverageLocation(SelectedActors));
+
+	GEditor->BeginTransaction(FText::FromString(TEXT("BlenderTool: Randomize")));
+	FToolDragSession RandomizeSession(GetWorld());
+	RandomizeGroup.Randomize(InLocationRange, InRotationRange, InScaleRange, bUniformScale, InSeed);
+	RandomizeSession.Commit(RandomizeGroup.GetAllChildActors());
 	GEditor->EndTransaction();
 }
 
@@ -234,6 +709,12 @@ void FBlenderViewportControlsEdMode::FinishActiveOperation(bool Success /** Fals
 	if (Success)
 	{
 		ActiveToolMode->ToolClose(true);
+
+		// Any accepted transform of the duplicates updates the delta that is repeated
+		if (RepeatDuplicateRecord.Duplicates.Num() > 0)
+		{
+			RepeatDuplicateRecord.RecordDeltas();
+		}
 	}
 	else
 	{
@@ -260,10 +741,93 @@ bool FBlenderViewportControlsEdMode::HasActiveSelection()
 
 void FBlenderViewportControlsEdMode::DuplicateSelection(FEditorViewportClient* InViewportClient)
 {
+	const TArray<AActor*> SourceActors = ToolHelperFunctions::GetSelectedLevelActors();
+
+	// Spawning the copies directly skips the command parsing and copy/paste path of the DUPLICATE exec command
+	TArray<AActor*> DuplicatedSources;
 	GEditor->BeginTransaction(FText::FromString(TEXT("BlenderTool: Duplicate")));
-	GEditor->Exec(GetWorld(), *FString("DUPLICATE"));
+	const TArray<AActor*> Duplicates = ToolHelperFunctions::DuplicateActors(SourceActors, nullptr, &DuplicatedSources);
+
+	TGuardValue<bool> SelectionGuard(bIsChangingSelection, true);
+	ToolHelperFunctions::SelectActors(Duplicates);
 	GEditor->EndTransaction();
+
+	if (Duplicates.Num() == 0)
+	{
+		return;
+	}
+
+	RepeatDuplicateRecord.Reset();
+	RepeatDuplicateRecord.Sources.Append(DuplicatedSources);
+	RepeatDuplicateRecord.Duplicates.Append(Duplicates);
 	
 	// We want to activate the move tool right away after duplication so the user can easily move the duplicates.
-	ActiveToolMode = MakeShared<FMoveMode>(InViewportClient, FText::FromString(TEXT("BlenderTool: Move")));
+	// The duplicates are handed over directly so the tool doesn't have to read them back from the selection.
+	ActiveToolMode = MakeShared<FMoveMode>(InViewportClient, FText::FromString(TEXT("BlenderTool: Move")), Duplicates);
+}
+
+void FBlenderViewportControlsEdMode::RepeatLastDuplicate(int32 InNumCopies)
+{
+	TArray<AActor*> Templates;
+	TArray<FTransform> SpawnTransforms;
+	Templates.Reserve(RepeatDuplicateRecord.Duplicates.Num());
+	SpawnTransforms.Reserve(RepeatDuplicateRecord.Duplicates.Num());
+	for (const TWeakObjectPtr<AActor>& Duplicate : RepeatDuplicateRecord.Duplicates)
+	{
+		// If any of the last duplicates was deleted the recorded deltas don't line up anymore
+		if (!Duplicate.IsValid())
+		{
+			RepeatDuplicateRecord.Reset();
+			return;
+		}
+
+		Templates.Add(Duplicate.Get());
+		SpawnTransforms.Add(Duplicate->GetActorTransform());
+	}
+
+	// Every copy is spawned directly at its final transform, all copies go into a single transaction
+	GEditor->BeginTransaction(FText::FromString(TEXT("BlenderTool: Repeat Duplicate")));
+	TArray<AActor*> LastSources;
+	for (int32 CopyIndex = 0; CopyIndex < InNumCopies && Templates.Num() == SpawnTransforms.Num(); ++CopyIndex)
+	{
+		for (int32 TemplateIndex = 0; TemplateIndex < SpawnTransforms.Num(); ++TemplateIndex)
+		{
+			SpawnTransforms[TemplateIndex] = SpawnTransforms[TemplateIndex] * RepeatDuplicateRecord.Deltas[TemplateIndex];
+		}
+
+		LastSources.Reset();
+		Templates = ToolHelperFunctions::DuplicateActors(Templates, &SpawnTransforms, &LastSources);
+	}
+
+	TGuardValue<bool> SelectionGuard(bIsChangingSelection, true);
+	ToolHelperFunctions::SelectActors(Templates);
+	GEditor->EndTransaction();
+
+	// The newest copies become the base of the next repeat, the delta stays the same
+	if (Templates.Num() != RepeatDuplicateRecord.Deltas.Num())
+	{
+		RepeatDuplicateRecord.Reset();
+		return;
+	}
+
+	RepeatDuplicateRecord.Sources.Reset();
+	RepeatDuplicateRecord.Sources.Append(LastSources);
+	RepeatDuplicateRecord.Duplicates.Reset();
+	RepeatDuplicateRecord.Duplicates.Append(Templates);
+}
+
+void FBlenderViewportControlsEdMode::FRepeatDuplicateRecord::RecordDeltas()
+{
+	Deltas.Reset(Duplicates.Num());
+	for (int32 Index = 0; Index < Duplicates.Num(); ++Index)
+	{
+		if (!Sources[Index].IsValid() || !Duplicates[Index].IsValid())
+		{
+			Reset();
+			return;
+		}
+
+		// World space delta between the source and its duplicate, Duplicate = Source * Delta
+		Deltas.Add(Sources[Index]->GetActorTransform().Inverse() * Duplicates[Index]->GetActorTransform());
+	}
 }
@@ -7,28 +7,74 @@
 #include "CanvasTypes.h"
 #include "EngineUtils.h"
 #include "EditorModeManager.h"
-#include "Components/LineBatchComponent.h"
 #include "Kismet/KismetMathLibrary.h"
 #include "Engine/Selection.h"
+#include "Async/ParallelFor.h"
+#include "Editor/TransBuffer.h"
+#include "ActorEditorUtils.h"
+#include "LevelUtils.h"
+#include "Physics/PhysicsInterfaceCore.h"
+#include "Engine/Brush.h"
+#include "BSPOps.h"
+#include "Editor.h"
+
+// Traces one worker runs under a single read lock of the physics scene
+static constexpr int32 TracesPerSceneLock = 64;
+
+// Projections of every viewport a tool was used in, keyed by the viewport client
+static TMap<const FEditorViewportClient*, FViewportProjection> ViewportProjections;
+
+bool FViewportProjection::IsValidFor(FEditorViewportClient* InViewportClient) const
+{
+	return ViewportType == (int32)InViewportClient->GetViewportType()
+		&& ViewportSize == InViewportClient->Viewport->GetSizeXY()
+		&& ViewLocation == InViewportClient->GetViewLocation()
+		&& ViewRotation == InViewportClient->GetViewRotation()
+		&& ViewFOV == InViewportClient->ViewFOV
+		&& OrthoZoom == InViewportClient->GetOrthoZoom();
+}
 
+void FViewportProjection::Update(FEditorViewportClient* InViewportClient)
+{
+	// The view is owned by the family, so everything we need is copied out before the family goes out of scope
+	FSceneViewFamilyContext ViewFamily(FSceneViewFamily::ConstructionValues(
+		InViewportClient->Viewport,
+		InViewportClient->GetScene(),
+		InViewportClient->EngineShowFlags));
 
-TTuple<FVector, FVector> ToolHelperFunctions::GetCursorWorldPosition(FEditorViewportClient* InViewportClient)
+	const FSceneView* View = InViewportClient->CalcSceneView(&ViewFamily);
+	ViewProjectionMatrix = View->ViewMatrices.GetViewProjectionMatrix();
+	InvViewProjectionMatrix = View->ViewMatrices.GetInvViewProjectionMatrix();
+	ViewRect = View->UnscaledViewRect;
+
+	ViewportType = (int32)InViewportClient->GetViewportType();
+	ViewportSize = InViewportClient->Viewport->GetSizeXY();
+	ViewLocation = InViewportClient->GetViewLocation();
+	ViewRotation = InViewportClient->GetViewRotation();
+	ViewFOV = InViewportClient->ViewFOV;
+	OrthoZoom = InViewportClient->GetOrthoZoom();
+}
+
+FIntPoint ToolHelperFunctions::GetCursorPosition(FEditorViewportClient* InViewportClient)
 {
-	FSceneView* View = GetSceneView(InViewportClient);
-	FIntPoint MousePosition = InViewportClient->GetCursorWorldLocationFromMousePos().GetCursorPos();
+	// Reading the mouse position directly, GetCursorWorldLocationFromMousePos would build a scene view for it
+	FIntPoint MousePosition;
+	InViewportClient->Viewport->GetMousePos(MousePosition);
 
-	FVector CursorWorldPosition, CursorWorldDirection;
-	View->DeprojectFVector2D(MousePosition, CursorWorldPosition, CursorWorldDirection);
-	
-	return TTuple<FVector, FVector>(CursorWorldPosition, CursorWorldDirection);
+	return MousePosition;
+}
+
+TTuple<FVector, FVector> ToolHelperFunctions::GetCursorWorldPosition(FEditorViewportClient* InViewportClient)
+{
+	return ProjectScreenPositionToWorld(InViewportClient, GetCursorPosition(InViewportClient));
 }
 
 TTuple<FVector, FVector> ToolHelperFunctions::ProjectScreenPositionToWorld(FEditorViewportClient* InViewportClient, const FIntPoint& InScreenPosition)
 {
-	FSceneView* View = GetSceneView(InViewportClient);
+	const FViewportProjection& Projection = GetViewportProjection(InViewportClient);
 
 	FVector CursorWorldPosition, CursorWorldDirection;
-	View->DeprojectFVector2D(InScreenPosition, CursorWorldPosition, CursorWorldDirection);
+	FSceneView::DeprojectScreenToWorld(FVector2D(InScreenPosition), Projection.ViewRect, Projection.InvViewProjectionMatrix, CursorWorldPosition, CursorWorldDirection);
 
 	return TTuple<FVector, FVector>(CursorWorldPosition, CursorWorldDirection);
 }
@@ -51,11 +97,7 @@ FVector ToolHelperFunctions::LinePlaneIntersectionFromCamera(FEditorViewportClie
 
 FIntPoint ToolHelperFunctions::ProjectWorldLocationToScreen(FEditorViewportClient* InViewportClient, FVector InWorldSpaceLocation, bool InClampValues)
 {
-	FSceneView* View = GetSceneView(InViewportClient);
-	
-	FVector2D OutScreenPos;
-	FMatrix const ViewProjectionMatrix = View->ViewMatrices.GetViewProjectionMatrix();
-	View->ProjectWorldToScreen(InWorldSpaceLocation, View->UnscaledViewRect, ViewProjectionMatrix, OutScreenPos);
+	FVector2D OutScreenPos(ProjectWorldLocationToScreen(GetViewportProjection(InViewportClient), InWorldSpaceLocation));
 	
 	//Clamp Values because ProjectWorldToScreen can give you negative values...
 	if (InClampValues)
@@ -68,17 +110,28 @@ FIntPoint ToolHelperFunctions::ProjectWorldLocationToScreen(FEditorViewportClien
 	return FIntPoint(OutScreenPos.X, OutScreenPos.Y);
 }
 
-FSceneView* ToolHelperFunctions::GetSceneView(FEditorViewportClient* InViewportClient)
+FIntPoint ToolHelperFunctions::ProjectWorldLocationToScreen(const FViewportProjection& InProjection, const FVector& InWorldSpaceLocation)
 {
-	FViewportCursorLocation MousePosition = InViewportClient->GetCursorWorldLocationFromMousePos();
-	FSceneViewFamilyContext ViewFamily(FSceneViewFamily::ConstructionValues(
-		InViewportClient->Viewport,
-		InViewportClient->GetScene(),
-		InViewportClient->EngineShowFlags));
+	FVector2D OutScreenPos;
+	FSceneView::ProjectWorldToScreen(InWorldSpaceLocation, InProjection.ViewRect, InProjection.ViewProjectionMatrix, OutScreenPos);
 
-	FSceneView* View = InViewportClient->CalcSceneView(&ViewFamily);
+	return FIntPoint(OutScreenPos.X, OutScreenPos.Y);
+}
+
+const FViewportProjection& ToolHelperFunctions::GetViewportProjection(FEditorViewportClient* InViewportClient)
+{
+	FViewportProjection& Projection = ViewportProjections.FindOrAdd(InViewportClient);
+	if (!Projection.IsValidFor(InViewportClient))
+	{
+		Projection.Update(InViewportClient);
+	}
 
-	return View;
+	return Projection;
+}
+
+void ToolHelperFunctions::ResetViewportProjections()
+{
+	ViewportProjections.Reset();
 }
 
 FBlenderViewportControlsEdMode* ToolHelperFunctions::GetEdMode()
@@ -102,51 +155,218 @@ FVector ToolHelperFunctions::GetAverageLocation(const TArray<AActor*>& SelectedA
 	return AverageLocation / SelectedActors.Num();
 }
 
-void ToolHelperFunctions::DrawAxisLine(const UWorld* InWorld, const FVector& InLineOrigin, const FVector& InLineDirection, const FLinearColor& InLineColor)
+TArray<AActor*> ToolHelperFunctions::GetSelectedLevelActors()
+{
+	TArray<AActor*> SelectedActors;
+	SelectedActors.Reserve(GEditor->GetSelectedActorCount());
+
+	USelection* CurrentSelection = GEditor->GetSelectedActors();
+	for (FSelectionIterator Iter(*CurrentSelection); Iter; ++Iter)
+	{
+		if (AActor* LevelActor = Cast<AActor>(*Iter))
+		{
+			SelectedActors.Add(LevelActor);
+		}
+	}
+
+	return SelectedActors;
+}
+
+TArray<AActor*> ToolHelperFunctions::GetActorsWithAttachedActors(const TArray<AActor*>& InActors)
+{
+	TSet<AActor*> Actors;
+	Actors.Append(InActors);
+
+	TArray<AActor*> AttachedActors;
+	for (const AActor* Actor : InActors)
+	{
+		AttachedActors.Reset();
+		Actor->GetAttachedActors(AttachedActors, false, true);
+		Actors.Append(AttachedActors);
+	}
+
+	return Actors.Array();
+}
+
+bool ToolHelperFunctions::IsSelectableInViewport(AActor* InActor)
+{
+	return InActor->GetRootComponent() && !InActor->IsHiddenEd() && InActor->IsSelectable() && !FActorEditorUtils::IsABuilderBrush(InActor) && !FLevelUtils::IsLevelLocked(InActor);
+}
+
+/** GetUndoSize walks every transaction in the buffer, the size is only measured again after the buffer changed */
+static TWeakObjectPtr<UTransBuffer> CachedUndoBuffer;
+static SIZE_T CachedUndoBufferSize = 0;
+static bool bUndoBufferSizeDirty = true;
+
+SIZE_T ToolHelperFunctions::GetUndoBufferSize()
+{
+	UTransBuffer* TransBuffer = Cast<UTransBuffer>(GEditor->Trans);
+	if (!TransBuffer)
+	{
+		return 0;
+	}
+
+	if (CachedUndoBuffer.Get() != TransBuffer)
+	{
+		CachedUndoBuffer = TransBuffer;
+		TransBuffer->OnUndoBufferChanged().AddLambda([]() { bUndoBufferSizeDirty = true; });
+		bUndoBufferSizeDirty = true;
+	}
+
+	if (bUndoBufferSizeDirty)
+	{
+		CachedUndoBufferSize = TransBuffer->GetUndoSize();
+		bUndoBufferSizeDirty = false;
+	}
+
+	return CachedUndoBufferSize;
+}
+
+void ToolHelperFunctions::SelectActors(const TArray<AActor*>& InActors)
 {
-	const float LineThickness = 3.f;
-	const float LifeTime = 1.f;
-	const float LineLength = 10000.f;
+	USelection* CurrentSelection = GEditor->GetSelectedActors();
+	CurrentSelection->BeginBatchSelectOperation();
 
-	FVector LineStart = InLineOrigin + (InLineDirection * LineLength);
-	FVector LineEnd = InLineOrigin + (-InLineDirection * LineLength);
+	GEditor->SelectNone(false, true, false);
+	for (AActor* Actor : InActors)
+	{
+		GEditor->SelectActor(Actor, true, false);
+	}
 
-	InWorld->LineBatcher->DrawLine(LineStart, LineEnd, InLineColor, 0, LineThickness, LifeTime);
+	CurrentSelection->EndBatchSelectOperation(false);
+	GEditor->NoteSelectionChange();
 }
 
-void ToolHelperFunctions::DrawDashedLine(FCanvas* InCanvas, const FVector& InLineStart, const FVector& InLineEnd, const float InLineThickness, const float InDashSize, const FLinearColor& InLineColor)
+/** 
+* Spawning from a template only recreates the components the class creates, components added to the instance in the editor are copied here.
+* All are duplicated first, so components attached to other instance components find their parent copy.
+*/
+static void DuplicateInstanceComponents(const AActor* InSourceActor, AActor* InNewActor)
 {
-	FBatchedElements* BatchedElements = InCanvas->GetBatchedElements(FCanvas::ET_Line);
-	FHitProxyId HitProxyId = InCanvas->GetHitProxyId();
+	TArray<TPair<UActorComponent*, UActorComponent*>> Copies;
+	for (UActorComponent* SourceComponent : InSourceActor->GetInstanceComponents())
+	{
+		if (!SourceComponent || SourceComponent == InSourceActor->GetRootComponent() || FindObjectFast<UActorComponent>(InNewActor, SourceComponent->GetFName()))
+		{
+			continue;
+		}
+
+		UActorComponent* NewComponent = DuplicateObject(SourceComponent, InNewActor, SourceComponent->GetFName());
+		InNewActor->AddInstanceComponent(NewComponent);
+		Copies.Emplace(SourceComponent, NewComponent);
+	}
 
-	// Draw multiple lines between start and end point so it looks dashed
+	for (const TPair<UActorComponent*, UActorComponent*>& Copy : Copies)
 	{
-		FVector LineDir = InLineEnd - InLineStart;
-		float LineLeft = (InLineEnd - InLineStart).Size();
-		if (LineLeft)
+		const USceneComponent* SourceSceneComponent = Cast<USceneComponent>(Copy.Key);
+		USceneComponent* NewSceneComponent = Cast<USceneComponent>(Copy.Value);
+		if (SourceSceneComponent && NewSceneComponent)
 		{
-			LineDir /= LineLeft;
+			// The duplicate still points at the parent of the source, it is attached to the component of the same name on the copy instead
+			const USceneComponent* SourceParent = SourceSceneComponent->GetAttachParent();
+			USceneComponent* NewParent = SourceParent ? FindObjectFast<USceneComponent>(InNewActor, SourceParent->GetFName()) : nullptr;
+			NewSceneComponent->SetupAttachment(NewParent ? NewParent : InNewActor->GetRootComponent(), SourceSceneComponent->GetAttachSocketName());
 		}
 
-		const int32 nLines = FMath::CeilToInt(LineLeft / (InDashSize * 2));
-		const FVector Dash = (InDashSize * LineDir);
+		Copy.Value->RegisterComponent();
+	}
+}
+
+TArray<AActor*> ToolHelperFunctions::DuplicateActors(const TArray<AActor*>& InActors, const TArray<FTransform>* InSpawnTransforms, TArray<AActor*>* OutSources)
+{
+	check(!InSpawnTransforms || InSpawnTransforms->Num() == InActors.Num());
+
+	TArray<AActor*> Duplicates;
+	Duplicates.Reserve(InActors.Num());
+
+	TMap<const AActor*, AActor*> SourceToDuplicate;
+	SourceToDuplicate.Reserve(InActors.Num());
+
+	// Labels are made unique against the labels of the world, which are collected once instead of once per copy
+	UWorld* World = InActors.Num() > 0 ? InActors[0]->GetWorld() : nullptr;
+	FCachedActorLabels ActorLabels(World);
+	bool bBrushesCopied = false;
 
-		FVector DrawStart = InLineStart;
-		while (LineLeft > InDashSize)
+	for (int32 ActorIndex = 0; ActorIndex < InActors.Num(); ++ActorIndex)
+	{
+		AActor* SourceActor = InActors[ActorIndex];
+
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.Template = SourceActor;
+		SpawnParams.OverrideLevel = SourceActor->GetLevel();
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+		SpawnParams.bNoFail = true;
+
+		const FTransform SpawnTransform = InSpawnTransforms ? (*InSpawnTransforms)[ActorIndex] : SourceActor->GetActorTransform();
+		if (AActor* NewActor = SourceActor->GetWorld()->SpawnActor(SourceActor->GetClass(), &SpawnTransform, SpawnParams))
 		{
-			const FVector DrawEnd = DrawStart + Dash;
+			DuplicateInstanceComponents(SourceActor, NewActor);
+
+			// The template shares its model with the copy, the copy gets its own so editing one brush doesn't change the other
+			if (ABrush* SourceBrush = Cast<ABrush>(SourceActor))
+			{
+				FBSPOps::csgCopyBrush(CastChecked<ABrush>(NewActor), SourceBrush, SourceBrush->PolyFlags, RF_Transactional, true, false);
+				bBrushesCopied = true;
+			}
 
-			BatchedElements->AddLine(DrawStart, DrawEnd, InLineColor, HitProxyId, InLineThickness);
+			FActorLabelUtilities::SetActorLabelUnique(NewActor, SourceActor->GetActorLabel(), &ActorLabels);
+			ActorLabels.Add(NewActor->GetActorLabel());
 
-			LineLeft -= 2 * InDashSize;
-			DrawStart = DrawEnd + Dash;
+			Duplicates.Add(NewActor);
+			SourceToDuplicate.Add(SourceActor, NewActor);
+
+			if (OutSources)
+			{
+				OutSources->Add(SourceActor);
+			}
 		}
-		if (LineLeft > 0.0f)
+	}
+
+	// Copies of attached actors are attached to the copy of their parent if it was duplicated as well, otherwise to the original parent
+	for (const TPair<const AActor*, AActor*>& Pair : SourceToDuplicate)
+	{
+		if (AActor* SourceParent = Pair.Key->GetAttachParentActor())
 		{
-			const FVector DrawEnd = InLineEnd;
-			BatchedElements->AddLine(DrawStart, DrawEnd, InLineColor, HitProxyId, InLineThickness);
+			AActor* DuplicateParent = SourceToDuplicate.FindRef(SourceParent);
+			Pair.Value->AttachToActor(DuplicateParent ? DuplicateParent : SourceParent, FAttachmentTransformRules::KeepWorldTransform, Pair.Key->GetAttachParentSocketName());
 		}
 	}
+
+	if (bBrushesCopied)
+	{
+		GEditor->RebuildAlteredBSP();
+	}
+
+	return Duplicates;
+}
+
+bool ToolHelperFunctions::ProjectWorldLineToScreen(FEditorViewportClient* InViewportClient, const FVector& InLineOrigin, const FVector& InLineDirection, FVector2D& OutStart, FVector2D& OutEnd)
+{
+	const FViewportProjection& Projection = GetViewportProjection(InViewportClient);
+
+	FVector2D ScreenOrigin, ScreenDirectionPoint;
+	if (!FSceneView::ProjectWorldToScreen(InLineOrigin, Projection.ViewRect, Projection.ViewProjectionMatrix, ScreenOrigin)
+		|| !FSceneView::ProjectWorldToScreen(InLineOrigin + InLineDirection * 100.f, Projection.ViewRect, Projection.ViewProjectionMatrix, ScreenDirectionPoint))
+	{
+		return false;
+	}
+
+	// Lines pointing straight at the camera collapse to a point
+	const FVector2D ScreenDirection = (ScreenDirectionPoint - ScreenOrigin).GetSafeNormal();
+	if (ScreenDirection.IsNearlyZero())
+	{
+		return false;
+	}
+
+	// Long enough to leave the viewport on both sides, even when the origin itself is outside of it
+	const FVector2D ViewSize = FVector2D(Projection.ViewRect.Size());
+	const FVector2D ViewCenter = FVector2D(Projection.ViewRect.Min) + ViewSize * 0.5f;
+	const float LineExtent = ViewSize.Size() + FVector2D::Distance(ScreenOrigin, ViewCenter);
+
+	OutStart = ScreenOrigin - ScreenDirection * LineExtent;
+	OutEnd = ScreenOrigin + ScreenDirection * LineExtent;
+
+	return true;
 }
 
 /**
@@ -208,3 +428,68 @@ FQuat ToolHelperFunctions::FindActorAlignmentRotation(const FQuat& InActorRotati
 
 	return InActorRotation * DeltaRotation;
 }
+
+void ToolHelperFunctions::FindActorAlignmentRotations(const TArray<FQuat>& InActorRotations, const FVector& InModelAxis, const TArray<FVector>& InWorldNormals, TArray<FQuat>& OutRotations)
+{
+	check(InActorRotations.Num() == InWorldNormals.Num());
+
+	const int32 NumRotations = InActorRotations.Num();
+	FQuatSoA Rotations;
+	FVectorSoA Normals;
+	Rotations.SetNum(NumRotations);
+	Normals.SetNum(NumRotations);
+	for (int32 Index = 0; Index < NumRotations; ++Index)
+	{
+		Rotations.Set(Index, FQuat4f(InActorRotations[Index]));
+		Normals.Set(Index, FVector3f(InWorldNormals[Index]));
+	}
+
+	FQuatSoA AlignedRotations;
+	TArray<int32> ScalarIndices;
+	ToolKernels::AlignToNormalsBatch(Rotations, Normals, FVector3f(InModelAxis), AlignedRotations, ScalarIndices);
+
+	OutRotations.SetNum(NumRotations, false);
+	for (int32 Index = 0; Index < NumRotations; ++Index)
+	{
+		OutRotations[Index] = FQuat(AlignedRotations.Get(Index));
+	}
+
+	// The model axis points exactly away from the normal, only FindBetween in the scalar version handles that
+	for (const int32 Index : ScalarIndices)
+	{
+		OutRotations[Index] = FindActorAlignmentRotation(InActorRotations[Index], InModelAxis, InWorldNormals[Index]);
+	}
+}
+
+void ToolHelperFunctions::LineTraceBatch(const UWorld* InWorld, const TArray<FVector>& InStarts, const TArray<FVector>& InEnds, const TArray<AActor*>& InIgnoredActors, TArray<FHitResult>& OutHits)
+{
+	check(InStarts.Num() == InEnds.Num());
+
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(BlenderViewportControlsTrace), true);
+	QueryParams.AddIgnoredActors(InIgnoredActors);
+
+	OutHits.Reset();
+	OutHits.SetNum(InStarts.Num());
+
+	FPhysScene* PhysicsScene = InWorld->GetPhysicsScene();
+	if (!PhysicsScene)
+	{
+		return;
+	}
+
+	// The traces are spread over the workers in chunks. Every worker holds a read lock of the physics scene while it traces its chunk, 
+	// so nothing writes to the scene in between and the game thread never waits on a lock the workers need
+	const int32 NumTraces = InStarts.Num();
+	const int32 NumChunks = FMath::DivideAndRoundUp(NumTraces, TracesPerSceneLock);
+	ParallelFor(NumChunks, [InWorld, PhysicsScene, NumTraces, &InStarts, &InEnds, &QueryParams, &OutHits](int32 ChunkIndex)
+	{
+		FPhysicsCommand::ExecuteRead(PhysicsScene, [InWorld, NumTraces, ChunkIndex, &InStarts, &InEnds, &QueryParams, &OutHits]()
+		{
+			const int32 EndIndex = FMath::Min((ChunkIndex + 1) * TracesPerSceneLock, NumTraces);
+			for (int32 Index = ChunkIndex * TracesPerSceneLock; Index < EndIndex; ++Index)
+			{
+				InWorld->LineTraceSingleByChannel(OutHits[Index], InStarts[Index], InEnds[Index], ECC_Visibility, QueryParams);
+			}
+		});
+	});
+}
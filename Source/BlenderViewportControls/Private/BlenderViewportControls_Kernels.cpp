@@ -0,0 +1,482 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "BlenderViewportControls_Kernels.h"
+
+void FVectorSoA::SetNum(int32 InNum)
+{
+	NumElements = InNum;
+
+	const int32 PaddedNum = Align(InNum, ToolKernelLaneWidth);
+	X.SetNumZeroed(PaddedNum);
+	Y.SetNumZeroed(PaddedNum);
+	Z.SetNumZeroed(PaddedNum);
+}
+
+void FVectorSoA::Set(int32 Index, const FVector3f& InVector)
+{
+	X[Index] = InVector.X;
+	Y[Index] = InVector.Y;
+	Z[Index] = InVector.Z;
+}
+
+void FQuatSoA::SetNum(int32 InNum)
+{
+	NumElements = InNum;
+
+	const int32 PaddedNum = Align(InNum, ToolKernelLaneWidth);
+	X.SetNumZeroed(PaddedNum);
+	Y.SetNumZeroed(PaddedNum);
+	Z.SetNumZeroed(PaddedNum);
+	W.SetNumZeroed(PaddedNum);
+}
+
+void FQuatSoA::Set(int32 Index, const FQuat4f& InQuat)
+{
+	X[Index] = InQuat.X;
+	Y[Index] = InQuat.Y;
+	Z[Index] = InQuat.Z;
+	W[Index] = InQuat.W;
+}
+
+// Components are stored in [-1/sqrt(2), 1/sqrt(2)], the range the three smallest components of a unit quaternion can have
+static constexpr uint32 PackedQuatBits = 20;
+static constexpr uint32 PackedQuatMask = (1u << PackedQuatBits) - 1;
+static constexpr float PackedQuatRange = UE_HALF_SQRT_2;
+
+FPackedQuat FPackedQuat::Pack(const FQuat4f& InQuat)
+{
+	const float Components[4] = { InQuat.X, InQuat.Y, InQuat.Z, InQuat.W };
+
+	int32 LargestIndex = 0;
+	for (int32 Index = 1; Index < 4; ++Index)
+	{
+		if (FMath::Abs(Components[Index]) > FMath::Abs(Components[LargestIndex]))
+		{
+			LargestIndex = Index;
+		}
+	}
+
+	// Q and -Q are the same rotation, flipping the sign so the largest component is positive means it can be rebuilt from the others
+	const float Sign = Components[LargestIndex] < 0.f ? -1.f : 1.f;
+
+	uint64 Bits = (uint64)LargestIndex << (3 * PackedQuatBits);
+	int32 Shift = 0;
+	for (int32 Index = 0; Index < 4; ++Index)
+	{
+		if (Index != LargestIndex)
+		{
+			const float Normalized = FMath::Clamp(Components[Index] * Sign / PackedQuatRange * 0.5f + 0.5f, 0.f, 1.f);
+			Bits |= (uint64)FMath::RoundToInt(Normalized * PackedQuatMask) << Shift;
+			Shift += PackedQuatBits;
+		}
+	}
+
+	FPackedQuat Packed;
+	Packed.Packed[0] = (uint32)Bits;
+	Packed.Packed[1] = (uint32)(Bits >> 32);
+	return Packed;
+}
+
+FQuat4f FPackedQuat::Unpack() const
+{
+	const uint64 Bits = (uint64)Packed[0] | ((uint64)Packed[1] << 32);
+	const int32 LargestIndex = (int32)(Bits >> (3 * PackedQuatBits)) & 3;
+
+	float Components[4];
+	float SumSquared = 0.f;
+	int32 Shift = 0;
+	for (int32 Index = 0; Index < 4; ++Index)
+	{
+		if (Index != LargestIndex)
+		{
+			const float Normalized = (float)((Bits >> Shift) & PackedQuatMask) / PackedQuatMask;
+			Components[Index] = (Normalized * 2.f - 1.f) * PackedQuatRange;
+			SumSquared += Components[Index] * Components[Index];
+			Shift += PackedQuatBits;
+		}
+	}
+
+	Components[LargestIndex] = FMath::Sqrt(FMath::Max(1.f - SumSquared, 0.f));
+	return FQuat4f(Components[0], Components[1], Components[2], Components[3]);
+}
+
+void FChildBasisSoA::SetNum(int32 InNum)
+{
+	Forward.SetNum(InNum);
+	Right.SetNum(InNum);
+	Up.SetNum(InNum);
+}
+
+void FChildBasisSoA::Set(int32 Index, const FQuat4f& InRotation)
+{
+	Forward.Set(Index, InRotation.GetForwardVector());
+	Right.Set(Index, InRotation.GetRightVector());
+	Up.Set(Index, InRotation.GetUpVector());
+}
+
+FVector ToolKernels::BiasScale(const FQuat& InRotation, const FVector& InScaleAxis, const FVector& InScale, bool bPlane)
+{
+	float X_Alpha = FMath::Abs(FVector::DotProduct(InScaleAxis, InRotation.GetForwardVector()));
+	float Y_Alpha = FMath::Abs(FVector::DotProduct(InScaleAxis, InRotation.GetRightVector()));
+	float Z_Alpha = FMath::Abs(FVector::DotProduct(InScaleAxis, InRotation.GetUpVector()));
+
+	if (bPlane)
+	{
+		X_Alpha = 1.f - X_Alpha;
+		Y_Alpha = 1.f - Y_Alpha;
+		Z_Alpha = 1.f - Z_Alpha;
+	}
+
+	return FVector(
+		FMath::Lerp(1.f, (float)InScale.X, X_Alpha),
+		FMath::Lerp(1.f, (float)InScale.Y, Y_Alpha),
+		FMath::Lerp(1.f, (float)InScale.Z, Z_Alpha));
+}
+
+/** |Axis . Basis| for four children at once */
+static FORCEINLINE VectorRegister4Float AxisAlignment4(const FVectorSoA& InBasis, int32 Index, const VectorRegister4Float& AxisX, const VectorRegister4Float& AxisY, const VectorRegister4Float& AxisZ)
+{
+	VectorRegister4Float Dot = VectorMultiply(AxisX, VectorLoad(&InBasis.X[Index]));
+	Dot = VectorMultiplyAdd(AxisY, VectorLoad(&InBasis.Y[Index]), Dot);
+	Dot = VectorMultiplyAdd(AxisZ, VectorLoad(&InBasis.Z[Index]), Dot);
+	return VectorAbs(Dot);
+}
+
+template<bool bPlane>
+static void BiasScaleBatchImpl(const FChildBasisSoA& InBasis, const FVector3f& InScaleAxis, const FVector3f& InScale, FVectorSoA& OutBiasScale)
+{
+	const VectorRegister4Float AxisX = VectorSetFloat1(InScaleAxis.X);
+	const VectorRegister4Float AxisY = VectorSetFloat1(InScaleAxis.Y);
+	const VectorRegister4Float AxisZ = VectorSetFloat1(InScaleAxis.Z);
+
+	// Lerp(1, Scale, Alpha) == 1 + (Scale - 1) * Alpha
+	const VectorRegister4Float One = GlobalVectorConstants::FloatOne;
+	const VectorRegister4Float ScaleDeltaX = VectorSetFloat1(InScale.X - 1.f);
+	const VectorRegister4Float ScaleDeltaY = VectorSetFloat1(InScale.Y - 1.f);
+	const VectorRegister4Float ScaleDeltaZ = VectorSetFloat1(InScale.Z - 1.f);
+
+	OutBiasScale.SetNum(InBasis.Num());
+
+	const int32 NumPadded = InBasis.Forward.NumPadded();
+	for (int32 Index = 0; Index < NumPadded; Index += ToolKernelLaneWidth)
+	{
+		VectorRegister4Float AlphaX = AxisAlignment4(InBasis.Forward, Index, AxisX, AxisY, AxisZ);
+		VectorRegister4Float AlphaY = AxisAlignment4(InBasis.Right, Index, AxisX, AxisY, AxisZ);
+		VectorRegister4Float AlphaZ = AxisAlignment4(InBasis.Up, Index, AxisX, AxisY, AxisZ);
+
+		if constexpr (bPlane)
+		{
+			AlphaX = VectorSubtract(One, AlphaX);
+			AlphaY = VectorSubtract(One, AlphaY);
+			AlphaZ = VectorSubtract(One, AlphaZ);
+		}
+
+		VectorStore(VectorMultiplyAdd(ScaleDeltaX, AlphaX, One), &OutBiasScale.X[Index]);
+		VectorStore(VectorMultiplyAdd(ScaleDeltaY, AlphaY, One), &OutBiasScale.Y[Index]);
+		VectorStore(VectorMultiplyAdd(ScaleDeltaZ, AlphaZ, One), &OutBiasScale.Z[Index]);
+	}
+}
+
+void ToolKernels::BiasScaleBatch(const FChildBasisSoA& InBasis, const FVector3f& InScaleAxis, const FVector3f& InScale, bool bPlane, FVectorSoA& OutBiasScale)
+{
+	if (bPlane)
+	{
+		BiasScaleBatchImpl<true>(InBasis, InScaleAxis, InScale, OutBiasScale);
+	}
+	else
+	{
+		BiasScaleBatchImpl<false>(InBasis, InScaleAxis, InScale, OutBiasScale);
+	}
+}
+
+/** Offsets of the four children starting at Index, lanes past the last child are zero */
+static FORCEINLINE void LoadOffsets4(const TArray<FChildRecord>& InRecords, int32 Index, VectorRegister4Float& OutX, VectorRegister4Float& OutY, VectorRegister4Float& OutZ)
+{
+	alignas(16) float X[ToolKernelLaneWidth] = {};
+	alignas(16) float Y[ToolKernelLaneWidth] = {};
+	alignas(16) float Z[ToolKernelLaneWidth] = {};
+
+	const int32 NumLanes = FMath::Min(ToolKernelLaneWidth, InRecords.Num() - Index);
+	for (int32 Lane = 0; Lane < NumLanes; ++Lane)
+	{
+		const FVector3f& Offset = InRecords[Index + Lane].Offset;
+		X[Lane] = Offset.X;
+		Y[Lane] = Offset.Y;
+		Z[Lane] = Offset.Z;
+	}
+
+	OutX = VectorLoadAligned(X);
+	OutY = VectorLoadAligned(Y);
+	OutZ = VectorLoadAligned(Z);
+}
+
+void ToolKernels::RotateOffsetsBatch(const TArray<FChildRecord>& InRecords, const FQuat4f& InRotation, FVectorSoA& OutOffsets)
+{
+	const VectorRegister4Float QX = VectorSetFloat1(InRotation.X);
+	const VectorRegister4Float QY = VectorSetFloat1(InRotation.Y);
+	const VectorRegister4Float QZ = VectorSetFloat1(InRotation.Z);
+	const VectorRegister4Float QW = VectorSetFloat1(InRotation.W);
+	const VectorRegister4Float Two = GlobalVectorConstants::FloatTwo;
+
+	OutOffsets.SetNum(InRecords.Num());
+
+	// Same as FQuat::RotateVector: T = 2 * (Q x V), V' = V + W * T + Q x T
+	const int32 NumPadded = OutOffsets.NumPadded();
+	for (int32 Index = 0; Index < NumPadded; Index += ToolKernelLaneWidth)
+	{
+		VectorRegister4Float VX, VY, VZ;
+		LoadOffsets4(InRecords, Index, VX, VY, VZ);
+
+		const VectorRegister4Float TX = VectorMultiply(Two, VectorNegateMultiplyAdd(QZ, VY, VectorMultiply(QY, VZ)));
+		const VectorRegister4Float TY = VectorMultiply(Two, VectorNegateMultiplyAdd(QX, VZ, VectorMultiply(QZ, VX)));
+		const VectorRegister4Float TZ = VectorMultiply(Two, VectorNegateMultiplyAdd(QY, VX, VectorMultiply(QX, VY)));
+
+		const VectorRegister4Float CrossX = VectorNegateMultiplyAdd(QZ, TY, VectorMultiply(QY, TZ));
+		const VectorRegister4Float CrossY = VectorNegateMultiplyAdd(QX, TZ, VectorMultiply(QZ, TX));
+		const VectorRegister4Float CrossZ = VectorNegateMultiplyAdd(QY, TX, VectorMultiply(QX, TY));
+
+		VectorStore(VectorAdd(VectorMultiplyAdd(QW, TX, VX), CrossX), &OutOffsets.X[Index]);
+		VectorStore(VectorAdd(VectorMultiplyAdd(QW, TY, VY), CrossY), &OutOffsets.Y[Index]);
+		VectorStore(VectorAdd(VectorMultiplyAdd(QW, TZ, VZ), CrossZ), &OutOffsets.Z[Index]);
+	}
+}
+
+void ToolKernels::ScaleOffsetsBatch(const TArray<FChildRecord>& InRecords, const FVector3f& InScale, FVectorSoA& OutOffsets)
+{
+	const VectorRegister4Float ScaleX = VectorSetFloat1(InScale.X);
+	const VectorRegister4Float ScaleY = VectorSetFloat1(InScale.Y);
+	const VectorRegister4Float ScaleZ = VectorSetFloat1(InScale.Z);
+
+	OutOffsets.SetNum(InRecords.Num());
+
+	const int32 NumPadded = OutOffsets.NumPadded();
+	for (int32 Index = 0; Index < NumPadded; Index += ToolKernelLaneWidth)
+	{
+		VectorRegister4Float VX, VY, VZ;
+		LoadOffsets4(InRecords, Index, VX, VY, VZ);
+
+		VectorStore(VectorMultiply(ScaleX, VX), &OutOffsets.X[Index]);
+		VectorStore(VectorMultiply(ScaleY, VY), &OutOffsets.Y[Index]);
+		VectorStore(VectorMultiply(ScaleZ, VZ), &OutOffsets.Z[Index]);
+	}
+}
+
+void ToolKernels::ScaleOffsetsBatch(const TArray<FChildRecord>& InRecords, const FVectorSoA& InScales, FVectorSoA& OutOffsets)
+{
+	check(InScales.Num() == InRecords.Num());
+
+	OutOffsets.SetNum(InRecords.Num());
+
+	const int32 NumPadded = OutOffsets.NumPadded();
+	for (int32 Index = 0; Index < NumPadded; Index += ToolKernelLaneWidth)
+	{
+		VectorRegister4Float VX, VY, VZ;
+		LoadOffsets4(InRecords, Index, VX, VY, VZ);
+
+		VectorStore(VectorMultiply(VectorLoad(&InScales.X[Index]), VX), &OutOffsets.X[Index]);
+		VectorStore(VectorMultiply(VectorLoad(&InScales.Y[Index]), VY), &OutOffsets.Y[Index]);
+		VectorStore(VectorMultiply(VectorLoad(&InScales.Z[Index]), VZ), &OutOffsets.Z[Index]);
+	}
+}
+
+void ToolKernels::MultiplyRotationsBatch(const FQuat4f& InLeft, const TArray<FChildRecord>& InRecords, const FQuat4f& InRight, TArray<FQuat4f>& OutRotations)
+{
+	// A quaternion fills a register on its own, so this runs one child per iteration instead of four
+	const VectorRegister4Float Left = VectorLoad(&InLeft.X);
+	const VectorRegister4Float Right = VectorLoad(&InRight.X);
+
+	OutRotations.SetNum(InRecords.Num(), false);
+	for (int32 Index = 0; Index < InRecords.Num(); ++Index)
+	{
+		const FQuat4f ChildRotation = InRecords[Index].Rotation.Unpack();
+		const VectorRegister4Float Rotation = VectorQuaternionMultiply2(Left, VectorLoad(&ChildRotation.X));
+		VectorStore(VectorQuaternionMultiply2(Rotation, Right), &OutRotations[Index].X);
+	}
+}
+
+/** Four vectors or quaternions, one component per register */
+struct FVectorLanes
+{
+	VectorRegister4Float X;
+	VectorRegister4Float Y;
+	VectorRegister4Float Z;
+};
+
+struct FQuatLanes
+{
+	VectorRegister4Float X;
+	VectorRegister4Float Y;
+	VectorRegister4Float Z;
+	VectorRegister4Float W;
+};
+
+static FORCEINLINE VectorRegister4Float Dot3Lanes(const FVectorLanes& A, const FVectorLanes& B)
+{
+	return VectorMultiplyAdd(A.Z, B.Z, VectorMultiplyAdd(A.Y, B.Y, VectorMultiply(A.X, B.X)));
+}
+
+static FORCEINLINE FVectorLanes CrossLanes(const FVectorLanes& A, const FVectorLanes& B)
+{
+	return {
+		VectorNegateMultiplyAdd(A.Z, B.Y, VectorMultiply(A.Y, B.Z)),
+		VectorNegateMultiplyAdd(A.X, B.Z, VectorMultiply(A.Z, B.X)),
+		VectorNegateMultiplyAdd(A.Y, B.X, VectorMultiply(A.X, B.Y)) };
+}
+
+static FORCEINLINE FVectorLanes SelectLanes(const VectorRegister4Float& Mask, const FVectorLanes& A, const FVectorLanes& B)
+{
+	return { VectorSelect(Mask, A.X, B.X), VectorSelect(Mask, A.Y, B.Y), VectorSelect(Mask, A.Z, B.Z) };
+}
+
+static FORCEINLINE FQuatLanes SelectLanes(const VectorRegister4Float& Mask, const FQuatLanes& A, const FQuatLanes& B)
+{
+	return { VectorSelect(Mask, A.X, B.X), VectorSelect(Mask, A.Y, B.Y), VectorSelect(Mask, A.Z, B.Z), VectorSelect(Mask, A.W, B.W) };
+}
+
+/** Same as FVector::GetSafeNormal, vectors that are too short become zero */
+static FORCEINLINE FVectorLanes SafeNormalLanes(const FVectorLanes& V)
+{
+	const VectorRegister4Float SizeSquared = Dot3Lanes(V, V);
+	const VectorRegister4Float ValidMask = VectorCompareGT(SizeSquared, VectorSetFloat1(SMALL_NUMBER));
+	const VectorRegister4Float InvSize = VectorSelect(ValidMask, VectorReciprocalSqrt(SizeSquared), GlobalVectorConstants::FloatZero);
+	return { VectorMultiply(V.X, InvSize), VectorMultiply(V.Y, InvSize), VectorMultiply(V.Z, InvSize) };
+}
+
+/** Same as FQuat::RotateVector */
+static FORCEINLINE FVectorLanes RotateVectorLanes(const FQuatLanes& Q, const FVectorLanes& V)
+{
+	const FVectorLanes QV = { Q.X, Q.Y, Q.Z };
+	const FVectorLanes Cross = CrossLanes(QV, V);
+	const VectorRegister4Float Two = GlobalVectorConstants::FloatTwo;
+	const FVectorLanes T = { VectorMultiply(Two, Cross.X), VectorMultiply(Two, Cross.Y), VectorMultiply(Two, Cross.Z) };
+	const FVectorLanes QT = CrossLanes(QV, T);
+	return {
+		VectorAdd(VectorMultiplyAdd(Q.W, T.X, V.X), QT.X),
+		VectorAdd(VectorMultiplyAdd(Q.W, T.Y, V.Y), QT.Y),
+		VectorAdd(VectorMultiplyAdd(Q.W, T.Z, V.Z), QT.Z) };
+}
+
+/** Inverse of a unit quaternion */
+static FORCEINLINE FQuatLanes ConjugateLanes(const FQuatLanes& Q)
+{
+	return { VectorNegate(Q.X), VectorNegate(Q.Y), VectorNegate(Q.Z), Q.W };
+}
+
+/** Same as FQuat A * B, B is applied first */
+static FORCEINLINE FQuatLanes MultiplyLanes(const FQuatLanes& A, const FQuatLanes& B)
+{
+	return {
+		VectorNegateMultiplyAdd(A.Z, B.Y, VectorMultiplyAdd(A.Y, B.Z, VectorMultiplyAdd(A.X, B.W, VectorMultiply(A.W, B.X)))),
+		VectorMultiplyAdd(A.Z, B.X, VectorMultiplyAdd(A.Y, B.W, VectorNegateMultiplyAdd(A.X, B.Z, VectorMultiply(A.W, B.Y)))),
+		VectorMultiplyAdd(A.Z, B.W, VectorNegateMultiplyAdd(A.Y, B.X, VectorMultiplyAdd(A.X, B.Y, VectorMultiply(A.W, B.Z)))),
+		VectorNegateMultiplyAdd(A.Z, B.Z, VectorNegateMultiplyAdd(A.Y, B.Y, VectorNegateMultiplyAdd(A.X, B.X, VectorMultiply(A.W, B.W)))) };
+}
+
+/** Same as FQuat(Axis, Angle) followed by Normalize */
+static FORCEINLINE FQuatLanes AxisAngleLanes(const FVectorLanes& Axis, const VectorRegister4Float& Angle)
+{
+	VectorRegister4Float Sin;
+	VectorRegister4Float Cos;
+	const VectorRegister4Float HalfAngle = VectorMultiply(Angle, GlobalVectorConstants::FloatOneHalf);
+	VectorSinCos(&Sin, &Cos, &HalfAngle);
+
+	const FQuatLanes Q = { VectorMultiply(Axis.X, Sin), VectorMultiply(Axis.Y, Sin), VectorMultiply(Axis.Z, Sin), Cos };
+	const VectorRegister4Float InvSize = VectorReciprocalSqrt(VectorMultiplyAdd(Q.W, Q.W, VectorMultiplyAdd(Q.Z, Q.Z, VectorMultiplyAdd(Q.Y, Q.Y, VectorMultiply(Q.X, Q.X)))));
+	return { VectorMultiply(Q.X, InvSize), VectorMultiply(Q.Y, InvSize), VectorMultiply(Q.Z, InvSize), VectorMultiply(Q.W, InvSize) };
+}
+
+/** FMath::Acos clamps its input, the vector version doesn't */
+static FORCEINLINE VectorRegister4Float ClampedACos(const VectorRegister4Float& X)
+{
+	return VectorACos(VectorMax(VectorMin(X, GlobalVectorConstants::FloatOne), GlobalVectorConstants::FloatMinusOne));
+}
+
+void ToolKernels::AlignToNormalsBatch(const FQuatSoA& InRotations, const FVectorSoA& InNormals, const FVector3f& InModelAxis, FQuatSoA& OutRotations, TArray<int32>& OutScalarIndices)
+{
+	check(InRotations.NumPadded() == InNormals.NumPadded());
+
+	const VectorRegister4Float Zero = GlobalVectorConstants::FloatZero;
+	const VectorRegister4Float One = GlobalVectorConstants::FloatOne;
+	const FVectorLanes ModelAxis = { VectorSetFloat1(InModelAxis.X), VectorSetFloat1(InModelAxis.Y), VectorSetFloat1(InModelAxis.Z) };
+	const FVectorLanes WorldZ = { Zero, Zero, One };
+	const FQuatLanes Identity = { Zero, Zero, Zero, One };
+
+	// Thresholds of the scalar version
+	const VectorRegister4Float ParallelThreshold = VectorSetFloat1(1.f - KINDA_SMALL_NUMBER);
+	const VectorRegister4Float PitchReferenceThreshold = VectorSetFloat1(0.7f);
+	const VectorRegister4Float CoincidentThreshold = VectorSetFloat1(0.98f);
+
+	OutRotations.SetNum(InRotations.Num());
+	OutScalarIndices.Reset();
+
+	const int32 NumPadded = InRotations.NumPadded();
+	for (int32 Index = 0; Index < NumPadded; Index += ToolKernelLaneWidth)
+	{
+		const FQuatLanes Rotation = { VectorLoad(&InRotations.X[Index]), VectorLoad(&InRotations.Y[Index]), VectorLoad(&InRotations.Z[Index]), VectorLoad(&InRotations.W[Index]) };
+		const FQuatLanes InverseRotation = ConjugateLanes(Rotation);
+		const FVectorLanes Normal = { VectorLoad(&InNormals.X[Index]), VectorLoad(&InNormals.Y[Index]), VectorLoad(&InNormals.Z[Index]) };
+
+		const FVectorLanes DestNormalModelSpace = RotateVectorLanes(InverseRotation, Normal);
+		const VectorRegister4Float NormalDot = Dot3Lanes(Normal, RotateVectorLanes(Rotation, ModelAxis));
+
+		// Parallel lanes keep their rotation, anti-parallel lanes are left to the scalar version
+		const VectorRegister4Float ParallelMask = VectorCompareGE(VectorAbs(NormalDot), ParallelThreshold);
+		const int32 AntiParallelBits = VectorMaskBits(VectorBitwiseAnd(ParallelMask, VectorCompareLT(NormalDot, Zero)));
+
+		// Pitch around the local axis between the reference axis and the model axis
+		FVectorLanes PitchReferenceAxis = RotateVectorLanes(InverseRotation, WorldZ);
+		const VectorRegister4Float UseNormalMask = VectorCompareGT(VectorAbs(Dot3Lanes(ModelAxis, PitchReferenceAxis)), PitchReferenceThreshold);
+		PitchReferenceAxis = SelectLanes(UseNormalMask, DestNormalModelSpace, PitchReferenceAxis);
+
+		const FVectorLanes PitchAxis = SafeNormalLanes(CrossLanes(PitchReferenceAxis, ModelAxis));
+		const VectorRegister4Float Pitch = VectorSubtract(ClampedACos(Dot3Lanes(PitchReferenceAxis, DestNormalModelSpace)), ClampedACos(Dot3Lanes(PitchReferenceAxis, ModelAxis)));
+		FQuatLanes DeltaRotation = AxisAngleLanes(PitchAxis, Pitch);
+
+		// Yaw around world Z for lanes where the pitched model axis is still too far from the normal
+		const FQuatLanes PitchedRotation = MultiplyLanes(Rotation, DeltaRotation);
+		const FVectorLanes PitchedModelAxis = RotateVectorLanes(PitchedRotation, ModelAxis);
+		const VectorRegister4Float YawMask = VectorCompareLT(Dot3Lanes(Normal, PitchedModelAxis), CoincidentThreshold);
+
+		const VectorRegister4Float Yaw = VectorSubtract(VectorATan2(Normal.X, Normal.Y), VectorATan2(PitchedModelAxis.X, PitchedModelAxis.Y));
+		const FVectorLanes WorldYawAxis = RotateVectorLanes(ConjugateLanes(PitchedRotation), WorldZ);
+		DeltaRotation = SelectLanes(YawMask, MultiplyLanes(DeltaRotation, AxisAngleLanes(WorldYawAxis, VectorNegate(Yaw))), DeltaRotation);
+
+		DeltaRotation = SelectLanes(ParallelMask, Identity, DeltaRotation);
+		const FQuatLanes Result = MultiplyLanes(Rotation, DeltaRotation);
+
+		VectorStore(Result.X, &OutRotations.X[Index]);
+		VectorStore(Result.Y, &OutRotations.Y[Index]);
+		VectorStore(Result.Z, &OutRotations.Z[Index]);
+		VectorStore(Result.W, &OutRotations.W[Index]);
+
+		for (int32 Lane = 0; AntiParallelBits != 0 && Lane < ToolKernelLaneWidth; ++Lane)
+		{
+			if ((AntiParallelBits & (1 << Lane)) != 0 && Index + Lane < InRotations.Num())
+			{
+				OutScalarIndices.Add(Index + Lane);
+			}
+		}
+	}
+}
+
+/** SplitMix64 finalizer, every input bit affects every output bit */
+static FORCEINLINE uint64 MixBits(uint64 Value)
+{
+	Value = (Value ^ (Value >> 30)) * 0xBF58476D1CE4E5B9ull;
+	Value = (Value ^ (Value >> 27)) * 0x94D049BB133111EBull;
+	return Value ^ (Value >> 31);
+}
+
+uint64 ToolKernels::RandomStream(const FGuid& InGuid, int32 InSeed)
+{
+	const uint64 High = ((uint64)InGuid.A << 32) | InGuid.B;
+	const uint64 Low = ((uint64)InGuid.C << 32) | InGuid.D;
+	return MixBits(MixBits(High ^ (uint32)InSeed) ^ Low);
+}
+
+float ToolKernels::SignedRandom(uint64 InStream, uint32 InCounter)
+{
+	// The top 24 bits fill the float mantissa exactly
+	const uint64 Bits = MixBits(InStream + ((uint64)InCounter + 1) * 0x9E3779B97F4A7C15ull);
+	return (float)(Bits >> 40) * (2.f / 16777216.f) - 1.f;
+}
@@ -0,0 +1,185 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "BlenderViewportControls_Overlay.h"
+#include "BlenderViewportControls.h"
+#include "CanvasItem.h"
+#include "CanvasTypes.h"
+#include "RenderUtils.h"
+#include "Engine/Engine.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("Overlay Rebuild"), STAT_BlenderViewportControls_OverlayRebuild, STATGROUP_BlenderViewportControls);
+
+static TAutoConsoleVariable<bool> CVarShowPerfOverlay(
+	TEXT("BlenderViewportControls.ShowPerfOverlay"),
+	false,
+	TEXT("Shows what the active tool costs per frame: children, update time split into cursor intersection, snap traces, math and write back, traces per frame and undo memory."),
+	ECVF_Default);
+
+// Look of the overlay
+static constexpr float OverlayLineThickness = 2.5f;
+static constexpr float OverlayAxisThickness = 2.f;
+static constexpr float OverlayDashSize = 10.f;
+static constexpr float OverlayPivotRadius = 5.f;
+
+// Placement of the performance overlay and how fast its times follow the frame times
+static const FVector2D PerfOverlayPosition(20.0, 40.0);
+static constexpr float PerfOverlayLineHeight = 16.f;
+static constexpr double PerfOverlaySmoothing = 0.1;
+
+void FToolOverlay::Update(const FToolOverlayState& InState)
+{
+	if (bHasState && InState == State)
+	{
+		return;
+	}
+
+	State = InState;
+	bHasState = true;
+	Rebuild();
+}
+
+void FToolOverlay::Draw(FCanvas* Canvas) const
+{
+	if (Triangles.Num() > 0)
+	{
+		FCanvasTriangleItem TriangleItem(Triangles, GWhiteTexture);
+		TriangleItem.BlendMode = SE_BLEND_Translucent;
+		Canvas->DrawItem(TriangleItem);
+	}
+
+	if (!Readout.IsEmpty())
+	{
+		Canvas->DrawShadowedString(State.CursorPosition.X + 16, State.CursorPosition.Y + 16, *Readout, GEngine->GetLargeFont(), FLinearColor::White);
+	}
+}
+
+void FToolOverlay::Rebuild()
+{
+	SCOPE_CYCLE_COUNTER(STAT_BlenderViewportControls_OverlayRebuild);
+
+	Triangles.Reset();
+
+	for (const FToolOverlayAxis& Axis : State.Axes)
+	{
+		AddLine(Axis.Start, Axis.End, OverlayAxisThickness, Axis.Color);
+	}
+
+	if (State.bDrawDashedLine)
+	{
+		AddDashedLine(FVector2D(State.CursorPosition), FVector2D(State.PivotPosition), OverlayLineThickness, OverlayDashSize, FLinearColor::White);
+	}
+
+	if (State.bDrawPivot)
+	{
+		AddDiamond(FVector2D(State.PivotPosition), OverlayPivotRadius, FLinearColor::White);
+	}
+}
+
+void FToolOverlay::AddLine(const FVector2D& InStart, const FVector2D& InEnd, float InThickness, const FLinearColor& InColor)
+{
+	const FVector2D Direction = (InEnd - InStart).GetSafeNormal();
+	const FVector2D Side = FVector2D(-Direction.Y, Direction.X) * (InThickness * 0.5f);
+
+	AddTriangle(InStart + Side, InEnd + Side, InEnd - Side, InColor);
+	AddTriangle(InStart + Side, InEnd - Side, InStart - Side, InColor);
+}
+
+void FToolOverlay::AddDashedLine(const FVector2D& InStart, const FVector2D& InEnd, float InThickness, float InDashSize, const FLinearColor& InColor)
+{
+	const float LineLength = FVector2D::Distance(InStart, InEnd);
+	if (LineLength <= UE_KINDA_SMALL_NUMBER)
+	{
+		return;
+	}
+
+	const FVector2D Dash = (InEnd - InStart) / LineLength * InDashSize;
+	const int32 NumDashes = FMath::CeilToInt(LineLength / (InDashSize * 2.f));
+	Triangles.Reserve(Triangles.Num() + NumDashes * 2);
+
+	// Every other segment is drawn, the last dash is cut off at the end of the line
+	for (int32 DashIndex = 0; DashIndex < NumDashes; ++DashIndex)
+	{
+		const FVector2D DashStart = InStart + Dash * (DashIndex * 2.f);
+		const float DashLength = FMath::Min(InDashSize, LineLength - DashIndex * 2.f * InDashSize);
+		AddLine(DashStart, DashStart + Dash * (DashLength / InDashSize), InThickness, InColor);
+	}
+}
+
+void FToolOverlay::AddDiamond(const FVector2D& InCenter, float InRadius, const FLinearColor& InColor)
+{
+	const FVector2D Top = InCenter + FVector2D(0.f, -InRadius);
+	const FVector2D Bottom = InCenter + FVector2D(0.f, InRadius);
+	const FVector2D Left = InCenter + FVector2D(-InRadius, 0.f);
+	const FVector2D Right = InCenter + FVector2D(InRadius, 0.f);
+
+	AddTriangle(Top, Right, Bottom, InColor);
+	AddTriangle(Top, Bottom, Left, InColor);
+}
+
+void FToolOverlay::AddTriangle(const FVector2D& InV0, const FVector2D& InV1, const FVector2D& InV2, const FLinearColor& InColor)
+{
+	FCanvasUVTri& Triangle = Triangles.AddDefaulted_GetRef();
+	Triangle.V0_Pos = InV0;
+	Triangle.V1_Pos = InV1;
+	Triangle.V2_Pos = InV2;
+	Triangle.V0_Color = InColor;
+	Triangle.V1_Color = InColor;
+	Triangle.V2_Color = InColor;
+}
+
+/**
+ * Performance Overlay
+ */
+FToolPerfStats& FToolPerfStats::Get()
+{
+	static FToolPerfStats Stats;
+	return Stats;
+}
+
+bool FToolPerfStats::IsEnabled()
+{
+	return CVarShowPerfOverlay.GetValueOnGameThread();
+}
+
+void FToolPerfStats::BeginFrame()
+{
+	// Anything timed outside of the update, e.g. reanchoring on a key press, is dropped
+	for (double& Seconds : FrameSeconds)
+	{
+		Seconds = 0.0;
+	}
+	FrameTraces = 0;
+}
+
+void FToolPerfStats::EndFrame(double InUpdateSeconds)
+{
+	double TimedSeconds = 0.0;
+	for (int32 Category = 0; Category < (int32)EToolPerfCategory::Num; ++Category)
+	{
+		TimedSeconds += FrameSeconds[Category];
+		SmoothedSeconds[Category] = FMath::Lerp(SmoothedSeconds[Category], FrameSeconds[Category], PerfOverlaySmoothing);
+	}
+
+	SmoothedMathSeconds = FMath::Lerp(SmoothedMathSeconds, FMath::Max(InUpdateSeconds - TimedSeconds, 0.0), PerfOverlaySmoothing);
+	SmoothedUpdateSeconds = FMath::Lerp(SmoothedUpdateSeconds, InUpdateSeconds, PerfOverlaySmoothing);
+	LastFrameTraces = FrameTraces;
+}
+
+void FToolPerfStats::Draw(FCanvas* Canvas, const FString& InOperationName, int32 InNumChildren, uint64 InUndoBytes) const
+{
+	const TArray<FString> Lines = {
+		FString::Printf(TEXT("%s: %d children"), *InOperationName, InNumChildren),
+		FString::Printf(TEXT("Update       %.2f ms"), SmoothedUpdateSeconds * 1000.0),
+		FString::Printf(TEXT("  Intersect  %.2f ms"), SmoothedSeconds[(uint8)EToolPerfCategory::Intersection] * 1000.0),
+		FString::Printf(TEXT("  Snap       %.2f ms  %d traces"), SmoothedSeconds[(uint8)EToolPerfCategory::SnapTraces] * 1000.0, LastFrameTraces),
+		FString::Printf(TEXT("  Math       %.2f ms"), SmoothedMathSeconds * 1000.0),
+		FString::Printf(TEXT("  Write back %.2f ms"), SmoothedSeconds[(uint8)EToolPerfCategory::WriteBack] * 1000.0),
+		FString::Printf(TEXT("Undo         %s"), *FText::AsMemory(InUndoBytes).ToString())
+	};
+
+	for (int32 LineIndex = 0; LineIndex < Lines.Num(); ++LineIndex)
+	{
+		Canvas->DrawShadowedString(PerfOverlayPosition.X, PerfOverlayPosition.Y + LineIndex * PerfOverlayLineHeight, *Lines[LineIndex], GEngine->GetSmallFont(), FLinearColor::White);
+	}
+}
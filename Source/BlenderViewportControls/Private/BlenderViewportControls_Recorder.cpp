@@ -0,0 +1,267 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "BlenderViewportControls_Recorder.h"
+#include "BlenderViewportControls_HelperFunctions.h"
+#include "EditorViewportClient.h"
+#include "Engine/Selection.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+// Bumped whenever the layout of the recording changes, old recordings are rejected instead of misread
+static constexpr uint32 RecordingMagic = 0x42564352;
+static constexpr uint32 RecordingVersion = 1;
+
+FArchive& operator<<(FArchive& Ar, FToolRecordedKey& Key)
+{
+	Ar << Key.KeyName;
+	Ar << Key.Event;
+	return Ar;
+}
+
+FArchive& operator<<(FArchive& Ar, FToolRecordedFrame& Frame)
+{
+	// Modifiers are packed into one byte, a frame is mostly cursor and camera
+	uint8 Modifiers = (Frame.Input.bShiftDown ? 1 : 0) | (Frame.Input.bCtrlDown ? 2 : 0) | (Frame.Input.bAltDown ? 4 : 0);
+
+	Ar << Frame.Input.CursorPosition;
+	Ar << Modifiers;
+	Ar << Frame.ViewLocation;
+	Ar << Frame.ViewRotation;
+	Ar << Frame.ViewFOV;
+	Ar << Frame.Keys;
+
+	Frame.Input.bShiftDown = (Modifiers & 1) != 0;
+	Frame.Input.bCtrlDown = (Modifiers & 2) != 0;
+	Frame.Input.bAltDown = (Modifiers & 4) != 0;
+
+	return Ar;
+}
+
+FArchive& operator<<(FArchive& Ar, FToolRecordedSession& Session)
+{
+	Ar << Session.ViewportSize;
+	Ar << Session.SelectedActorPaths;
+	Ar << Session.Frames;
+	return Ar;
+}
+
+bool FToolRecordedSession::Save(const FString& InFilename)
+{
+	TUniquePtr<FArchive> Writer(IFileManager::Get().CreateFileWriter(*InFilename));
+	if (!Writer)
+	{
+		return false;
+	}
+
+	uint32 Magic = RecordingMagic;
+	uint32 Version = RecordingVersion;
+	*Writer << Magic;
+	*Writer << Version;
+	*Writer << *this;
+
+	return Writer->Close();
+}
+
+bool FToolRecordedSession::Load(const FString& InFilename)
+{
+	TUniquePtr<FArchive> Reader(IFileManager::Get().CreateFileReader(*InFilename));
+	if (!Reader)
+	{
+		return false;
+	}
+
+	uint32 Magic = 0;
+	uint32 Version = 0;
+	*Reader << Magic;
+	*Reader << Version;
+	if (Magic != RecordingMagic || Version != RecordingVersion)
+	{
+		return false;
+	}
+
+	*Reader << *this;
+
+	return !Reader->IsError();
+}
+
+/**
+ * Recorder
+ */
+void FToolSessionRecorder::Start(FEditorViewportClient* InViewportClient)
+{
+	RecordedViewportClient = InViewportClient;
+	Session = FToolRecordedSession();
+	Session.ViewportSize = InViewportClient->Viewport->GetSizeXY();
+	PendingKeys.Reset();
+
+	// The replay starts from the same selection
+	for (AActor* Actor : ToolHelperFunctions::GetSelectedLevelActors())
+	{
+		Session.SelectedActorPaths.Add(Actor->GetPathName());
+	}
+
+	UE_LOG(LogBlenderTool, Log, TEXT("Recording started with %d selected actors"), Session.SelectedActorPaths.Num());
+}
+
+bool FToolSessionRecorder::Stop(const FString& InFilename)
+{
+	RecordedViewportClient = nullptr;
+
+	const bool bSaved = Session.Save(InFilename);
+	if (bSaved)
+	{
+		UE_LOG(LogBlenderTool, Log, TEXT("Recorded %d frames to %s"), Session.Frames.Num(), *InFilename);
+	}
+	else
+	{
+		UE_LOG(LogBlenderTool, Error, TEXT("Could not write the recording to %s"), *InFilename);
+	}
+
+	Session = FToolRecordedSession();
+	return bSaved;
+}
+
+void FToolSessionRecorder::RecordKey(FEditorViewportClient* InViewportClient, const FKey& InKey, EInputEvent InEvent)
+{
+	// The replay only has the recorded viewport to send keys to, keys of other viewports would make it diverge
+	if (InViewportClient != RecordedViewportClient)
+	{
+		return;
+	}
+
+	FToolRecordedKey& RecordedKey = PendingKeys.AddDefaulted_GetRef();
+	RecordedKey.KeyName = InKey.GetFName().ToString();
+	RecordedKey.Event = (uint8)InEvent;
+}
+
+void FToolSessionRecorder::RecordFrame(FEditorViewportClient* InViewportClient)
+{
+	if (InViewportClient != RecordedViewportClient)
+	{
+		return;
+	}
+
+	FToolRecordedFrame& Frame = Session.Frames.AddDefaulted_GetRef();
+	Frame.Input = FToolInputState::Get(InViewportClient);
+	Frame.ViewLocation = InViewportClient->GetViewLocation();
+	Frame.ViewRotation = InViewportClient->GetViewRotation();
+	Frame.ViewFOV = InViewportClient->ViewFOV;
+	Frame.Keys = MoveTemp(PendingKeys);
+	PendingKeys.Reset();
+}
+
+/**
+ * Replayer
+ */
+bool FToolSessionReplayer::Start(const FString& InFilename, FEditorViewportClient* InViewportClient)
+{
+	Session = FToolRecordedSession();
+	if (!Session.Load(InFilename))
+	{
+		UE_LOG(LogBlenderTool, Error, TEXT("Could not read the recording %s"), *InFilename);
+		return false;
+	}
+
+	if (Session.ViewportSize != InViewportClient->Viewport->GetSizeXY())
+	{
+		UE_LOG(LogBlenderTool, Warning, TEXT("The recording was made in a %dx%d viewport, this one is %dx%d. Cursor positions will not match exactly"),
+			Session.ViewportSize.X, Session.ViewportSize.Y, InViewportClient->Viewport->GetSizeX(), InViewportClient->Viewport->GetSizeY());
+	}
+
+	// Start from the recorded selection
+	TArray<AActor*> SelectedActors;
+	for (const FString& ActorPath : Session.SelectedActorPaths)
+	{
+		if (AActor* Actor = FindObject<AActor>(nullptr, *ActorPath))
+		{
+			SelectedActors.Add(Actor);
+		}
+	}
+
+	if (SelectedActors.Num() != Session.SelectedActorPaths.Num())
+	{
+		UE_LOG(LogBlenderTool, Warning, TEXT("%d of the recorded actors were not found"), Session.SelectedActorPaths.Num() - SelectedActors.Num());
+	}
+
+	ToolHelperFunctions::SelectActors(SelectedActors);
+
+	ReplayedViewportClient = InViewportClient;
+	ResultFilename = FPaths::ChangeExtension(InFilename, TEXT("csv"));
+	FrameIndex = 0;
+	FrameSeconds.Reset(Session.Frames.Num());
+
+	FToolInputState::SetReplayedInput(&ReplayedInput);
+
+	UE_LOG(LogBlenderTool, Log, TEXT("Replaying %d frames from %s"), Session.Frames.Num(), *InFilename);
+	return true;
+}
+
+bool FToolSessionReplayer::BeginFrame(TArray<FKey>& OutKeys, TArray<EInputEvent>& OutEvents)
+{
+	if (!Session.Frames.IsValidIndex(FrameIndex))
+	{
+		return false;
+	}
+
+	const FToolRecordedFrame& Frame = Session.Frames[FrameIndex];
+	ReplayedInput = Frame.Input;
+
+	ReplayedViewportClient->SetViewLocation(Frame.ViewLocation);
+	ReplayedViewportClient->SetViewRotation(Frame.ViewRotation);
+	ReplayedViewportClient->ViewFOV = Frame.ViewFOV;
+
+	for (const FToolRecordedKey& Key : Frame.Keys)
+	{
+		OutKeys.Add(FKey(*Key.KeyName));
+		OutEvents.Add((EInputEvent)Key.Event);
+	}
+
+	return true;
+}
+
+void FToolSessionReplayer::EndFrame(double InFrameSeconds)
+{
+	FrameSeconds.Add(InFrameSeconds);
+	++FrameIndex;
+}
+
+void FToolSessionReplayer::Finish()
+{
+	FToolInputState::SetReplayedInput(nullptr);
+	ReplayedViewportClient = nullptr;
+
+	double TotalSeconds = 0.0;
+	double MaxSeconds = 0.0;
+
+	FString Result = TEXT("Frame,Milliseconds\n");
+	for (int32 Index = 0; Index < FrameSeconds.Num(); ++Index)
+	{
+		TotalSeconds += FrameSeconds[Index];
+		MaxSeconds = FMath::Max(MaxSeconds, FrameSeconds[Index]);
+		Result += FString::Printf(TEXT("%d,%.4f\n"), Index, FrameSeconds[Index] * 1000.0);
+	}
+
+	// Final transforms, comparing them between builds shows whether a change also changed the result
+	Result += TEXT("\nActor,LocationX,LocationY,LocationZ,Pitch,Yaw,Roll,ScaleX,ScaleY,ScaleZ\n");
+	for (AActor* Actor : ToolHelperFunctions::GetSelectedLevelActors())
+	{
+		const FVector Location = Actor->GetActorLocation();
+		const FRotator Rotation = Actor->GetActorRotation();
+		const FVector Scale = Actor->GetActorScale3D();
+		Result += FString::Printf(TEXT("%s,%f,%f,%f,%f,%f,%f,%f,%f,%f\n"), *Actor->GetPathName(),
+			Location.X, Location.Y, Location.Z, Rotation.Pitch, Rotation.Yaw, Rotation.Roll, Scale.X, Scale.Y, Scale.Z);
+	}
+
+	if (!FFileHelper::SaveStringToFile(Result, *ResultFilename))
+	{
+		UE_LOG(LogBlenderTool, Error, TEXT("Could not write the replay results to %s"), *ResultFilename);
+	}
+
+	const int32 NumFrames = FMath::Max(FrameSeconds.Num(), 1);
+	UE_LOG(LogBlenderTool, Log, TEXT("Replayed %d frames: %.3f ms total, %.3f ms average, %.3f ms max. Results written to %s"),
+		FrameSeconds.Num(), TotalSeconds * 1000.0, TotalSeconds * 1000.0 / NumFrames, MaxSeconds * 1000.0, *ResultFilename);
+
+	Session = FToolRecordedSession();
+	FrameSeconds.Reset();
+}
@@ -0,0 +1,459 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "BlenderViewportControls_Selection.h"
+#include "BlenderViewportControls.h"
+#include "BlenderViewportControls_Tools.h"
+#include "Async/ParallelFor.h"
+#include "CanvasItem.h"
+#include "CanvasTypes.h"
+#include "Editor.h"
+#include "EditorViewportClient.h"
+#include "Engine/Selection.h"
+#include "EngineUtils.h"
+
+static TAutoConsoleVariable<float> CVarSelectionGridCellSize(
+	TEXT("BlenderViewportControls.SelectionGridCellSize"),
+	64.f,
+	TEXT("Cell size in pixels of the screen space grid used by box and circle selection."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarCircleSelectRadius(
+	TEXT("BlenderViewportControls.CircleSelectRadius"),
+	50.f,
+	TEXT("Radius in pixels the circle selection brush starts with. Scrolling changes it while the circle selection is active."),
+	ECVF_Default);
+
+DECLARE_CYCLE_STAT(TEXT("Selection Grid Build"), STAT_BlenderViewportControls_SelectionGridBuild, STATGROUP_BlenderViewportControls);
+DECLARE_CYCLE_STAT(TEXT("Selection Query"), STAT_BlenderViewportControls_SelectionQuery, STATGROUP_BlenderViewportControls);
+
+// Projecting the bounds of fewer actors than this is not worth the task overhead
+static constexpr int32 ParallelProjectMinActors = 1024;
+
+// Limits of the circle brush and how much one scroll step changes it
+static constexpr float CircleRadiusMin = 5.f;
+static constexpr float CircleRadiusMax = 1000.f;
+static constexpr float CircleRadiusStep = 1.1f;
+static constexpr int32 CircleSegments = 32;
+
+/**
+ * Grid
+ */
+void FScreenSpaceActorGrid::Build(FEditorViewportClient* InViewportClient, float InCellSize)
+{
+	SCOPE_CYCLE_COUNTER(STAT_BlenderViewportControls_SelectionGridBuild);
+
+	check(InCellSize > 0.f);
+	CellSize = InCellSize;
+	BuiltViewportClient = InViewportClient;
+	BuiltProjection = ToolHelperFunctions::GetViewportProjection(InViewportClient);
+	bDirty = false;
+
+	Actors.Reset();
+	ScreenBounds.Reset();
+
+	// The bounds are read on the game thread, only the projection runs in parallel
+	TArray<FBox> WorldBounds;
+	for (TActorIterator<AActor> It(InViewportClient->GetWorld()); It; ++It)
+	{
+		AActor* Actor = *It;
+		if (!ToolHelperFunctions::IsSelectableInViewport(Actor))
+		{
+			continue;
+		}
+
+		// Actors without primitives are still selectable at their location
+		const FBox Bounds = Actor->GetComponentsBoundingBox(true);
+		Actors.Add(Actor);
+		WorldBounds.Add(Bounds.IsValid ? Bounds : FBox(Actor->GetActorLocation(), Actor->GetActorLocation()));
+	}
+
+	const FViewportProjection& Projection = BuiltProjection;
+	ScreenBounds.SetNumUninitialized(Actors.Num());
+	ParallelFor(Actors.Num(), [this, &WorldBounds, &Projection](int32 ActorIndex)
+	{
+		FVector Corners[8];
+		WorldBounds[ActorIndex].GetVertices(Corners);
+
+		// Corners behind the camera are left out, actors that are completely behind it stay invalid and are never selected
+		FBox2D Bounds(ForceInit);
+		for (const FVector& Corner : Corners)
+		{
+			FVector2D ScreenPosition;
+			if (FSceneView::ProjectWorldToScreen(Corner, Projection.ViewRect, Projection.ViewProjectionMatrix, ScreenPosition))
+			{
+				Bounds += ScreenPosition;
+			}
+		}
+
+		ScreenBounds[ActorIndex] = Bounds;
+	}, Actors.Num() < ParallelProjectMinActors);
+
+	// Only the view rect is bucketed, actors outside of it can't be under the cursor
+	const FIntRect& ViewRect = Projection.ViewRect;
+	const FBox2D ViewBox(FVector2D(ViewRect.Min), FVector2D(ViewRect.Max));
+	NumCells = FIntPoint(
+		FMath::Max(FMath::CeilToInt(ViewRect.Width() / CellSize), 1),
+		FMath::Max(FMath::CeilToInt(ViewRect.Height() / CellSize), 1));
+
+	// Count the actors per cell first, so the sorted indices can be written in a single pass afterwards
+	CellStarts.Reset();
+	CellStarts.SetNumZeroed(NumCells.X * NumCells.Y + 1);
+	for (int32 ActorIndex = 0; ActorIndex < Actors.Num(); ++ActorIndex)
+	{
+		const FBox2D& Bounds = ScreenBounds[ActorIndex];
+		if (!Bounds.bIsValid || !Bounds.Intersect(ViewBox))
+		{
+			continue;
+		}
+
+		const FIntPoint MinCell = GetCell(Bounds.Min);
+		const FIntPoint MaxCell = GetCell(Bounds.Max);
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+		{
+			for (int32 X = MinCell.X; X <= MaxCell.X; ++X)
+			{
+				CellStarts[Y * NumCells.X + X + 1]++;
+			}
+		}
+	}
+
+	for (int32 CellIndex = 1; CellIndex < CellStarts.Num(); ++CellIndex)
+	{
+		CellStarts[CellIndex] += CellStarts[CellIndex - 1];
+	}
+
+	TArray<int32> CellCursors(CellStarts);
+	SortedIndices.SetNumUninitialized(CellStarts.Last());
+	for (int32 ActorIndex = 0; ActorIndex < Actors.Num(); ++ActorIndex)
+	{
+		const FBox2D& Bounds = ScreenBounds[ActorIndex];
+		if (!Bounds.bIsValid || !Bounds.Intersect(ViewBox))
+		{
+			continue;
+		}
+
+		const FIntPoint MinCell = GetCell(Bounds.Min);
+		const FIntPoint MaxCell = GetCell(Bounds.Max);
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+		{
+			for (int32 X = MinCell.X; X <= MaxCell.X; ++X)
+			{
+				SortedIndices[CellCursors[Y * NumCells.X + X]++] = ActorIndex;
+			}
+		}
+	}
+
+	UE_LOG(LogBlenderTool, Verbose, TEXT("Selection grid: %d actors in %dx%d cells"), Actors.Num(), NumCells.X, NumCells.Y);
+}
+
+bool FScreenSpaceActorGrid::IsValidFor(FEditorViewportClient* InViewportClient) const
+{
+	return !bDirty && BuiltViewportClient == InViewportClient && BuiltProjection.IsValidFor(InViewportClient);
+}
+
+FIntPoint FScreenSpaceActorGrid::GetCell(const FVector2D& InScreenPosition) const
+{
+	const FIntPoint& ViewMin = BuiltProjection.ViewRect.Min;
+	return FIntPoint(
+		FMath::Clamp(FMath::FloorToInt((InScreenPosition.X - ViewMin.X) / CellSize), 0, NumCells.X - 1),
+		FMath::Clamp(FMath::FloorToInt((InScreenPosition.Y - ViewMin.Y) / CellSize), 0, NumCells.Y - 1));
+}
+
+template<typename FunctionType>
+void FScreenSpaceActorGrid::ForEachActorInBox(const FBox2D& InBox, FunctionType&& InFunction) const
+{
+	if (CellStarts.Num() == 0)
+	{
+		return;
+	}
+
+	const FIntPoint MinCell = GetCell(InBox.Min);
+	const FIntPoint MaxCell = GetCell(InBox.Max);
+
+	for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+	{
+		for (int32 X = MinCell.X; X <= MaxCell.X; ++X)
+		{
+			const int32 CellIndex = Y * NumCells.X + X;
+			for (int32 SortedIndex = CellStarts[CellIndex]; SortedIndex < CellStarts[CellIndex + 1]; ++SortedIndex)
+			{
+				// Actors are listed in every cell they overlap, they are only reported from the first of those cells the query visits
+				const int32 ActorIndex = SortedIndices[SortedIndex];
+				const FIntPoint ActorMinCell = GetCell(ScreenBounds[ActorIndex].Min);
+				if (X == FMath::Max(ActorMinCell.X, MinCell.X) && Y == FMath::Max(ActorMinCell.Y, MinCell.Y))
+				{
+					InFunction(ActorIndex);
+				}
+			}
+		}
+	}
+}
+
+void FScreenSpaceActorGrid::QueryBox(const FBox2D& InBox, TArray<AActor*>& OutActors) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_BlenderViewportControls_SelectionQuery);
+
+	ForEachActorInBox(InBox, [this, &InBox, &OutActors](int32 ActorIndex)
+	{
+		AActor* Actor = Actors[ActorIndex].Get();
+		if (Actor && ScreenBounds[ActorIndex].Intersect(InBox))
+		{
+			OutActors.Add(Actor);
+		}
+	});
+}
+
+void FScreenSpaceActorGrid::QueryCircle(const FVector2D& InCenter, float InRadius, TArray<AActor*>& OutActors) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_BlenderViewportControls_SelectionQuery);
+
+	const FBox2D CircleBox(InCenter - FVector2D(InRadius), InCenter + FVector2D(InRadius));
+	const double RadiusSquared = FMath::Square((double)InRadius);
+
+	ForEachActorInBox(CircleBox, [this, &InCenter, RadiusSquared, &OutActors](int32 ActorIndex)
+	{
+		AActor* Actor = Actors[ActorIndex].Get();
+		if (Actor && ScreenBounds[ActorIndex].ComputeSquaredDistanceToPoint(InCenter) <= RadiusSquared)
+		{
+			OutActors.Add(Actor);
+		}
+	});
+}
+
+/**
+ * Tool
+ */
+FViewportSelectionTool::FViewportSelectionTool()
+{
+	CircleRadius = CVarCircleSelectRadius.GetValueOnGameThread();
+
+	// The grid only follows the camera by itself, anything that moves, adds or removes actors has to invalidate it
+	ActorMovedHandle = GEngine->OnActorMoved().AddLambda([this](AActor*) { Grid.Invalidate(); });
+	ActorAddedHandle = GEngine->OnLevelActorAdded().AddLambda([this](AActor*) { Grid.Invalidate(); });
+	ActorDeletedHandle = GEngine->OnLevelActorDeleted().AddLambda([this](AActor*) { Grid.Invalidate(); });
+	UndoRedoHandle = FEditorDelegates::PostUndoRedo.AddLambda([this]() { Grid.Invalidate(); });
+}
+
+FViewportSelectionTool::~FViewportSelectionTool()
+{
+	End();
+
+	if (GEngine)
+	{
+		GEngine->OnActorMoved().Remove(ActorMovedHandle);
+		GEngine->OnLevelActorAdded().Remove(ActorAddedHandle);
+		GEngine->OnLevelActorDeleted().Remove(ActorDeletedHandle);
+	}
+
+	FEditorDelegates::PostUndoRedo.Remove(UndoRedoHandle);
+}
+
+void FViewportSelectionTool::Begin(FEditorViewportClient* InViewportClient, EViewportSelectionMode InMode)
+{
+	End();
+
+	Mode = InMode;
+	ViewportClient = InViewportClient;
+	UpdateGrid();
+}
+
+void FViewportSelectionTool::End()
+{
+	// A stroke that is still running keeps what it selected so far
+	if (bDragging)
+	{
+		GEditor->EndTransaction();
+		bDragging = false;
+	}
+
+	Mode = EViewportSelectionMode::None;
+	ViewportClient = nullptr;
+}
+
+bool FViewportSelectionTool::InputKey(FEditorViewportClient* InViewportClient, const FKey& InKey, EInputEvent InEvent)
+{
+	if (!IsActiveIn(InViewportClient))
+	{
+		return false;
+	}
+
+	// Left mouse button adds, shift + left or the middle mouse button removes like in Blender
+	if ((InKey == EKeys::LeftMouseButton || InKey == EKeys::MiddleMouseButton) && InEvent == IE_Pressed && !bDragging)
+	{
+		bDragging = true;
+		bDeselect = InKey == EKeys::MiddleMouseButton || FToolInputState::Get(InViewportClient).bShiftDown;
+		DragStart = ToolHelperFunctions::GetCursorPosition(InViewportClient);
+		LastPaintPosition = FIntPoint(-1, -1);
+
+		GEditor->BeginTransaction(FText::FromString(Mode == EViewportSelectionMode::Box ? TEXT("BlenderTool: Box Select") : TEXT("BlenderTool: Circle Select")));
+		return true;
+	}
+
+	if ((InKey == EKeys::LeftMouseButton || InKey == EKeys::MiddleMouseButton) && InEvent == IE_Released && bDragging)
+	{
+		if (Mode == EViewportSelectionMode::Box)
+		{
+			const FVector2D CursorPosition(ToolHelperFunctions::GetCursorPosition(InViewportClient));
+			FBox2D Box(ForceInit);
+			Box += FVector2D(DragStart);
+			Box += CursorPosition;
+
+			UpdateGrid();
+
+			TArray<AActor*> BoxActors;
+			Grid.QueryBox(Box, BoxActors);
+			ApplySelection(BoxActors, !bDeselect);
+
+			// Ends the transaction as well
+			End();
+		}
+		else
+		{
+			GEditor->EndTransaction();
+			bDragging = false;
+		}
+
+		return true;
+	}
+
+	if ((InKey == EKeys::RightMouseButton || InKey == EKeys::Escape) && InEvent == IE_Pressed)
+	{
+		End();
+		return true;
+	}
+
+	if (Mode == EViewportSelectionMode::Circle)
+	{
+		if (InKey == EKeys::Enter && InEvent == IE_Pressed)
+		{
+			End();
+			return true;
+		}
+
+		if (InKey == EKeys::MouseScrollUp)
+		{
+			CircleRadius = FMath::Min(CircleRadius * CircleRadiusStep, CircleRadiusMax);
+			return true;
+		}
+
+		if (InKey == EKeys::MouseScrollDown)
+		{
+			CircleRadius = FMath::Max(CircleRadius / CircleRadiusStep, CircleRadiusMin);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void FViewportSelectionTool::Tick(FEditorViewportClient* InViewportClient)
+{
+	if (Mode != EViewportSelectionMode::Circle || !bDragging || InViewportClient != ViewportClient)
+	{
+		return;
+	}
+
+	// The brush only paints where the cursor went since the last tick
+	const FIntPoint CursorPosition = ToolHelperFunctions::GetCursorPosition(InViewportClient);
+	if (CursorPosition == LastPaintPosition)
+	{
+		return;
+	}
+
+	LastPaintPosition = CursorPosition;
+	UpdateGrid();
+
+	TArray<AActor*> BrushActors;
+	Grid.QueryCircle(FVector2D(CursorPosition), CircleRadius, BrushActors);
+	ApplySelection(BrushActors, !bDeselect);
+}
+
+void FViewportSelectionTool::DrawHUD(FCanvas* Canvas) const
+{
+	if (!IsActive())
+	{
+		return;
+	}
+
+	const FVector2D CursorPosition(ToolHelperFunctions::GetCursorPosition(ViewportClient));
+	const FLinearColor Color = bDragging && bDeselect ? FLinearColor::Red : FLinearColor::White;
+
+	if (Mode == EViewportSelectionMode::Box)
+	{
+		if (bDragging)
+		{
+			const FVector2D Start(DragStart);
+			const FVector2D Min(FMath::Min(Start.X, CursorPosition.X), FMath::Min(Start.Y, CursorPosition.Y));
+			const FVector2D Max(FMath::Max(Start.X, CursorPosition.X), FMath::Max(Start.Y, CursorPosition.Y));
+
+			FCanvasBoxItem BoxItem(Min, Max - Min);
+			BoxItem.SetColor(Color);
+			Canvas->DrawItem(BoxItem);
+		}
+		else
+		{
+			// Crosshair through the cursor until the rectangle is started
+			const FIntPoint ViewportSize = ViewportClient->Viewport->GetSizeXY();
+
+			FCanvasLineItem HorizontalLine(FVector2D(0.0, CursorPosition.Y), FVector2D(ViewportSize.X, CursorPosition.Y));
+			HorizontalLine.SetColor(Color);
+			Canvas->DrawItem(HorizontalLine);
+
+			FCanvasLineItem VerticalLine(FVector2D(CursorPosition.X, 0.0), FVector2D(CursorPosition.X, ViewportSize.Y));
+			VerticalLine.SetColor(Color);
+			Canvas->DrawItem(VerticalLine);
+		}
+	}
+	else
+	{
+		FVector2D LastPoint = CursorPosition + FVector2D(CircleRadius, 0.0);
+		for (int32 Segment = 1; Segment <= CircleSegments; ++Segment)
+		{
+			const float Angle = UE_TWO_PI * Segment / CircleSegments;
+			const FVector2D Point = CursorPosition + FVector2D(FMath::Cos(Angle), FMath::Sin(Angle)) * CircleRadius;
+
+			FCanvasLineItem LineItem(LastPoint, Point);
+			LineItem.SetColor(Color);
+			Canvas->DrawItem(LineItem);
+
+			LastPoint = Point;
+		}
+	}
+}
+
+void FViewportSelectionTool::UpdateGrid()
+{
+	if (!Grid.IsValidFor(ViewportClient))
+	{
+		Grid.Build(ViewportClient, FMath::Max(CVarSelectionGridCellSize.GetValueOnGameThread(), 1.f));
+	}
+}
+
+void FViewportSelectionTool::ApplySelection(const TArray<AActor*>& InActors, bool bSelect)
+{
+	// Actors that already are in the requested state are skipped, a brush stroke hits the same actors over and over
+	TArray<AActor*> ChangedActors;
+	for (AActor* Actor : InActors)
+	{
+		if (Actor->IsSelected() != bSelect)
+		{
+			ChangedActors.Add(Actor);
+		}
+	}
+
+	if (ChangedActors.Num() == 0)
+	{
+		return;
+	}
+
+	USelection* CurrentSelection = GEditor->GetSelectedActors();
+	CurrentSelection->BeginBatchSelectOperation();
+
+	for (AActor* Actor : ChangedActors)
+	{
+		GEditor->SelectActor(Actor, bSelect, false);
+	}
+
+	CurrentSelection->EndBatchSelectOperation(false);
+	GEditor->NoteSelectionChange();
+}
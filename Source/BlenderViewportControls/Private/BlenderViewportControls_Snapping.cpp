@@ -0,0 +1,65 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "BlenderViewportControls_Snapping.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<int32> CVarSnapMode(
+	TEXT("BlenderViewportControls.SnapMode"),
+	0,
+	TEXT("Snap mode for moving and scaling.\n")
+	TEXT(" 0: Relative increments along the world axes\n")
+	TEXT(" 1: Absolute increments of the offset length (scale: of the resulting scale)\n")
+	TEXT(" 2: World grid\n")
+	TEXT(" 3: Local grid"),
+	ECVF_Default);
+
+EToolSnapMode ToolSnapping::GetSnapMode()
+{
+	const int32 SnapMode = FMath::Clamp(CVarSnapMode.GetValueOnGameThread(), 0, (int32)EToolSnapMode::LocalGrid);
+	return (EToolSnapMode)SnapMode;
+}
+
+FVector ToolSnapping::SnapOffset(const FVector& InOffset, const FVector& InOrigin, const FQuat& InLocalRotation, float InIncrement, EToolSnapMode InMode)
+{
+	if (InIncrement <= 0.f)
+	{
+		return InOffset;
+	}
+
+	switch (InMode)
+	{
+	case EToolSnapMode::AbsoluteIncrement:
+	{
+		const float SnappedLength = FMath::GridSnap((float)InOffset.Size(), InIncrement);
+		return InOffset.GetSafeNormal() * SnappedLength;
+	}
+	case EToolSnapMode::WorldGrid:
+		return (InOrigin + InOffset).GridSnap(InIncrement) - InOrigin;
+	case EToolSnapMode::LocalGrid:
+	{
+		const FVector LocalOffset = InLocalRotation.UnrotateVector(InOffset).GridSnap(InIncrement);
+		return InLocalRotation.RotateVector(LocalOffset);
+	}
+	case EToolSnapMode::RelativeIncrement:
+	default:
+		return InOffset.GridSnap(InIncrement);
+	}
+}
+
+float ToolSnapping::SnapScale(float InMultiplier, float InReferenceScale, float InIncrement, EToolSnapMode InMode)
+{
+	if (InIncrement <= 0.f)
+	{
+		return InMultiplier;
+	}
+
+	// Grids don't mean anything for scale, those modes fall back to relative increments.
+	// Snapping never goes down to zero, a zero scale can't be scaled back up.
+	if (InMode == EToolSnapMode::AbsoluteIncrement && !FMath::IsNearlyZero(InReferenceScale))
+	{
+		const float SnappedScale = FMath::Max(FMath::GridSnap(InReferenceScale * InMultiplier, InIncrement), InIncrement);
+		return SnappedScale / InReferenceScale;
+	}
+
+	return FMath::Max(FMath::GridSnap(InMultiplier, InIncrement), InIncrement);
+}
@@ -0,0 +1,222 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "BlenderViewportControls_SpatialIndex.h"
+
+void FSpatialPointGrid::Build(TArray<FVector>&& InPoints, float InCellSize)
+{
+	Reset();
+
+	check(InCellSize > 0.f);
+	CellSize = InCellSize;
+	Points = MoveTemp(InPoints);
+	Bounds = FBox(Points);
+
+	// Count the points per cell first, so the sorted indices can be written in a single pass afterwards
+	TArray<FIntVector> PointCells;
+	PointCells.SetNumUninitialized(Points.Num());
+	for (int32 PointIndex = 0; PointIndex < Points.Num(); ++PointIndex)
+	{
+		PointCells[PointIndex] = GetCell(Points[PointIndex]);
+		Cells.FindOrAdd(PointCells[PointIndex], TPair<int32, int32>(0, 0)).Value++;
+	}
+
+	int32 FirstIndex = 0;
+	for (TPair<FIntVector, TPair<int32, int32>>& Cell : Cells)
+	{
+		Cell.Value.Key = FirstIndex;
+		FirstIndex += Cell.Value.Value;
+		Cell.Value.Value = 0;
+	}
+
+	SortedIndices.SetNumUninitialized(Points.Num());
+	for (int32 PointIndex = 0; PointIndex < Points.Num(); ++PointIndex)
+	{
+		TPair<int32, int32>& Cell = Cells.FindChecked(PointCells[PointIndex]);
+		SortedIndices[Cell.Key + Cell.Value] = PointIndex;
+		Cell.Value++;
+	}
+}
+
+void FSpatialPointGrid::Reset()
+{
+	CellSize = 0.f;
+	Points.Reset();
+	SortedIndices.Reset();
+	Cells.Reset();
+	Bounds = FBox(ForceInit);
+}
+
+FIntVector FSpatialPointGrid::GetCell(const FVector& InLocation) const
+{
+	return FIntVector(
+		FMath::FloorToInt(InLocation.X / CellSize),
+		FMath::FloorToInt(InLocation.Y / CellSize),
+		FMath::FloorToInt(InLocation.Z / CellSize));
+}
+
+template<typename FunctionType>
+void FSpatialPointGrid::ForEachPointInSphere(const FVector& InCenter, float InRadius, FunctionType&& InFunction) const
+{
+	if (!IsBuilt())
+	{
+		return;
+	}
+
+	const FIntVector MinCell = GetCell(InCenter - FVector(InRadius));
+	const FIntVector MaxCell = GetCell(InCenter + FVector(InRadius));
+	const double RadiusSquared = FMath::Square((double)InRadius);
+
+	for (int32 X = MinCell.X; X <= MaxCell.X; ++X)
+	{
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+		{
+			for (int32 Z = MinCell.Z; Z <= MaxCell.Z; ++Z)
+			{
+				const TPair<int32, int32>* Cell = Cells.Find(FIntVector(X, Y, Z));
+				if (!Cell)
+				{
+					continue;
+				}
+
+				for (int32 SortedIndex = Cell->Key; SortedIndex < Cell->Key + Cell->Value; ++SortedIndex)
+				{
+					const int32 PointIndex = SortedIndices[SortedIndex];
+					if (FVector::DistSquared(Points[PointIndex], InCenter) <= RadiusSquared)
+					{
+						InFunction(PointIndex);
+					}
+				}
+			}
+		}
+	}
+}
+
+void FSpatialPointGrid::QuerySphere(const FVector& InCenter, float InRadius, TArray<int32>& OutIndices) const
+{
+	ForEachPointInSphere(InCenter, InRadius, [&OutIndices](int32 PointIndex)
+	{
+		OutIndices.Add(PointIndex);
+	});
+}
+
+template<typename FunctionType>
+void FSpatialPointGrid::ForEachCellInCone(const FVector& InRayOrigin, const FVector& InRayDirection, double InRadius, double InRadiusPerDistance, FunctionType&& InFunction) const
+{
+	if (!IsBuilt() || !Bounds.IsValid)
+	{
+		return;
+	}
+
+	// A cell can only hold points of the cone if its bounding sphere touches the cone
+	const double CellHalfDiagonal = CellSize * UE_HALF_SQRT_3;
+	const bool bPerspective = InRadiusPerDistance > 0.0;
+	auto IsCellInCone = [&](const FIntVector& InCell)
+	{
+		const FVector CellCenter = (FVector(InCell) + FVector(0.5)) * CellSize;
+		const double Distance = FVector::DotProduct(CellCenter - InRayOrigin, InRayDirection);
+		if (bPerspective && Distance < -CellHalfDiagonal)
+		{
+			return false;
+		}
+
+		const double ConeRadius = InRadius + InRadiusPerDistance * FMath::Max(Distance + CellHalfDiagonal, 0.0);
+		return FMath::PointDistToLine(CellCenter, InRayDirection, InRayOrigin) <= ConeRadius + CellHalfDiagonal;
+	};
+
+	// Only the part of the ray alongside the points can find anything. Orthographic views see points behind the ray origin as well
+	double MinDistance = TNumericLimits<double>::Max();
+	double MaxDistance = -TNumericLimits<double>::Max();
+	for (int32 Corner = 0; Corner < 8; ++Corner)
+	{
+		const FVector CornerLocation((Corner & 1) ? Bounds.Max.X : Bounds.Min.X, (Corner & 2) ? Bounds.Max.Y : Bounds.Min.Y, (Corner & 4) ? Bounds.Max.Z : Bounds.Min.Z);
+		const double Distance = FVector::DotProduct(CornerLocation - InRayOrigin, InRayDirection);
+		MinDistance = FMath::Min(MinDistance, Distance);
+		MaxDistance = FMath::Max(MaxDistance, Distance);
+	}
+	if (bPerspective)
+	{
+		MinDistance = FMath::Max(MinDistance, 0.0);
+	}
+
+	// Walk along the ray in steps of at least one cell and visit the cells around every step. Wide cones can cover more cells than are occupied,
+	// then the occupied cells are scanned instead
+	TSet<FIntVector> VisitedCells;
+	for (double Distance = MinDistance; Distance < MaxDistance;)
+	{
+		const double Step = FMath::Max((double)CellSize, InRadius + InRadiusPerDistance * Distance);
+		const double Extent = Step * 0.5 + InRadius + InRadiusPerDistance * (Distance + Step);
+		const FVector StepCenter = InRayOrigin + InRayDirection * (Distance + Step * 0.5);
+
+		const FIntVector MinCell = GetCell(StepCenter - FVector(Extent));
+		const FIntVector MaxCell = GetCell(StepCenter + FVector(Extent));
+		const int64 NumStepCells = (int64)(MaxCell.X - MinCell.X + 1) * (MaxCell.Y - MinCell.Y + 1) * (MaxCell.Z - MinCell.Z + 1);
+		if (VisitedCells.Num() + NumStepCells > Cells.Num())
+		{
+			for (const TPair<FIntVector, TPair<int32, int32>>& Cell : Cells)
+			{
+				if (!VisitedCells.Contains(Cell.Key) && IsCellInCone(Cell.Key))
+				{
+					InFunction(Cell.Value.Key, Cell.Value.Value);
+				}
+			}
+			return;
+		}
+
+		for (int32 X = MinCell.X; X <= MaxCell.X; ++X)
+		{
+			for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+			{
+				for (int32 Z = MinCell.Z; Z <= MaxCell.Z; ++Z)
+				{
+					const FIntVector CellKey(X, Y, Z);
+					bool bAlreadyVisited = false;
+					VisitedCells.Add(CellKey, &bAlreadyVisited);
+					if (bAlreadyVisited || !IsCellInCone(CellKey))
+					{
+						continue;
+					}
+
+					if (const TPair<int32, int32>* Cell = Cells.Find(CellKey))
+					{
+						InFunction(Cell->Key, Cell->Value);
+					}
+				}
+			}
+		}
+
+		Distance += Step;
+	}
+}
+
+int32 FSpatialPointGrid::FindNearestToRay(const FVector& InRayOrigin, const FVector& InRayDirection, float InRadius, float InRadiusPerDistance) const
+{
+	int32 NearestIndex = INDEX_NONE;
+	double NearestScore = TNumericLimits<double>::Max();
+	double NearestDepth = TNumericLimits<double>::Max();
+
+	ForEachCellInCone(InRayOrigin, InRayDirection, InRadius, InRadiusPerDistance, [&](int32 FirstSortedIndex, int32 NumPoints)
+	{
+		for (int32 SortedIndex = FirstSortedIndex; SortedIndex < FirstSortedIndex + NumPoints; ++SortedIndex)
+		{
+			const int32 PointIndex = SortedIndices[SortedIndex];
+			const FVector& Point = Points[PointIndex];
+
+			const double Depth = FVector::DotProduct(Point - InRayOrigin, InRayDirection);
+			const double ConeRadius = InRadius + InRadiusPerDistance * Depth;
+			if (ConeRadius <= 0.0)
+			{
+				continue;
+			}
+
+			const double Score = FMath::PointDistToLine(Point, InRayDirection, InRayOrigin) / ConeRadius;
+			if (Score <= 1.0 && (Score < NearestScore || (Score == NearestScore && Depth < NearestDepth)))
+			{
+				NearestScore = Score;
+				NearestDepth = Depth;
+				NearestIndex = PointIndex;
+			}
+		}
+	});
+
+	return NearestIndex;
+}
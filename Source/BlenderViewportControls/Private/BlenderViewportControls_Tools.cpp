@@ -1,47 +1,376 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "BlenderViewportControls_Tools.h"
+#include "BlenderViewportControls.h"
 #include "BlenderViewportControls_HelperFunctions.h"
+#include "BlenderViewportControls_Snapping.h"
+#include "Components/StaticMeshComponent.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "StaticMeshResources.h"
+#include "HAL/IConsoleManager.h"
 #include "ViewportWorldInteraction.h"
 #include "EngineUtils.h"
 #include "DrawDebugHelpers.h"
 #include "Kismet/KismetMathLibrary.h"
-#include "Components/LineBatchComponent.h"
 #include "Engine/Selection.h"
-
+#include "Async/ParallelFor.h"
+#include "AI/NavigationSystemBase.h"
+#include "Misc/ITransaction.h"
+#include "Engine/Brush.h"
+#include "Engine/Light.h"
+#include "GameFramework/Info.h"
+#include "LandscapeProxy.h"
+#include "UObject/GarbageCollection.h"
+
+DEFINE_LOG_CATEGORY(LogBlenderTool);
 DEFINE_LOG_CATEGORY(LogMoveTool);
 DEFINE_LOG_CATEGORY(LogRotateTool);
 DEFINE_LOG_CATEGORY(LogScaleTool);
 
+// Below this many children preparing the target transforms on worker threads costs more than it saves
+static constexpr int32 ParallelPrepareMinChildren = 1024;
+
+static TAutoConsoleVariable<bool> CVarSnapToVertices(
+	TEXT("BlenderViewportControls.SnapToVertices"),
+	false,
+	TEXT("When true, Alt snapping in move mode also snaps to static mesh vertices and not only to actor origins."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarMoveSnapTarget(
+	TEXT("BlenderViewportControls.MoveSnapTarget"),
+	0,
+	TEXT("What holding Ctrl snaps to in move mode, like the snap element in Blender.\n")
+	TEXT(" 0: Surfaces under the cursor, aligned to their normal\n")
+	TEXT(" 1: Increments of the grid size (BlenderViewportControls.SnapMode)"),
+	ECVF_Default);
+
+// Cell size of the snap point grid and the screen space radius in which points are snapped to
+static constexpr float SnapPointGridCellSize = 200.f;
+static constexpr float SnapPointScreenRadius = 20.f;
+
+static TAutoConsoleVariable<int32> CVarOutlineTintMaxActors(
+	TEXT("BlenderViewportControls.OutlineTintMaxActors"),
+	10000,
+	TEXT("Selections with more actors than this keep the default selection outline color while a tool is active. 0 never tints the outline."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarProgressiveStartupMinActors(
+	TEXT("BlenderViewportControls.ProgressiveStartupMinActors"),
+	10000,
+	TEXT("Selections with at least this many actors start the tool right away around the editor pivot and build the group on a worker thread. 0 always builds it before the tool starts."),
+	ECVF_Default);
+
+// Outline color of the selection while a tool is active
+static const FLinearColor ToolOutlineColor = FLinearColor::White;
+
+DECLARE_CYCLE_STAT(TEXT("Outline Tint"), STAT_BlenderViewportControls_OutlineTint, STATGROUP_BlenderViewportControls);
+DECLARE_MEMORY_STAT(TEXT("Group Child Memory"), STAT_BlenderViewportControls_GroupMemory, STATGROUP_BlenderViewportControls);
+
 // User defined offset for the MoveTool surface snap. ( I wanted this to persist between operations, but not between plugin restarts )
 static float SavedSnapOffset = 0.f;
 
+// How far surface snapping traces from the camera through every child
+static constexpr double SurfaceSnapTraceDistance = 10000000.0;
+
+// Proportional editing state, persists between operations the same way
+static bool bSavedProportionalEditing = false;
+static float SavedProportionalRadius = 1000.f;
+
+static EToolPivotMode SavedPivotMode = EToolPivotMode::Median;
+
+// Factor the proportional radius changes by per scroll step
+static constexpr float ProportionalRadiusStep = 1.1f;
+
+/**
+ * Drag Session
+ */
+FToolDragSession::FToolDragSession(UWorld* InWorld)
+	: NavigationLock(MakeUnique<FNavigationLockContext>(InWorld, ENavigationLockReason::ContinuousEditorMove))
+{
+}
+
+FToolDragSession::~FToolDragSession()
+{
+	// Releasing the lock without a commit still flushes whatever got dirtied while the tool was live
+	NavigationLock.Reset();
+}
+
+void FToolDragSession::Commit(const TArray<AActor*>& InMovedActors)
+{
+	// Attached actors were moved by their parents, they need to know that they were moved as well
+	TArray<AActor*> AttachedActors;
+	for (AActor* Actor : InMovedActors)
+	{
+		Actor->GetAttachedActors(AttachedActors, false, true);
+	}
+
+	for (AActor* Actor : InMovedActors)
+	{
+		Actor->PostEditMove(true);
+	}
+
+	for (AActor* Actor : AttachedActors)
+	{
+		Actor->PostEditMove(true);
+	}
+
+	NavigationLock.Reset();
+}
+
+/**
+ * Input State
+ */
+static const FToolInputState* ReplayedInputState = nullptr;
+
+FToolInputState FToolInputState::Get(FEditorViewportClient* InViewportClient)
+{
+	if (ReplayedInputState)
+	{
+		return *ReplayedInputState;
+	}
+
+	FToolInputState InputState;
+	InputState.CursorPosition = ToolHelperFunctions::GetCursorPosition(InViewportClient);
+	InputState.bShiftDown = InViewportClient->IsShiftPressed();
+	InputState.bCtrlDown = InViewportClient->IsCtrlPressed();
+	InputState.bAltDown = InViewportClient->IsAltPressed();
+
+	return InputState;
+}
+
+void FToolInputState::SetReplayedInput(const FToolInputState* InReplayedInput)
+{
+	ReplayedInputState = InReplayedInput;
+}
+
+/**
+ * Numeric Input
+ */
+bool FToolNumericInput::HandleKey(const FKey& InKey)
+{
+	static const FKey DigitKeys[] = { EKeys::Zero, EKeys::One, EKeys::Two, EKeys::Three, EKeys::Four, EKeys::Five, EKeys::Six, EKeys::Seven, EKeys::Eight, EKeys::Nine };
+	static const FKey NumPadKeys[] = { EKeys::NumPadZero, EKeys::NumPadOne, EKeys::NumPadTwo, EKeys::NumPadThree, EKeys::NumPadFour, EKeys::NumPadFive, EKeys::NumPadSix, EKeys::NumPadSeven, EKeys::NumPadEight, EKeys::NumPadNine };
+
+	for (int32 Digit = 0; Digit < UE_ARRAY_COUNT(DigitKeys); ++Digit)
+	{
+		if (InKey == DigitKeys[Digit] || InKey == NumPadKeys[Digit])
+		{
+			Digits.AppendChar(TCHAR(TEXT('0') + Digit));
+			return true;
+		}
+	}
+
+	if (InKey == EKeys::Period || InKey == EKeys::Decimal)
+	{
+		if (!Digits.Contains(TEXT(".")))
+		{
+			Digits += Digits.IsEmpty() ? TEXT("0.") : TEXT(".");
+		}
+		return true;
+	}
+
+	// Minus toggles the sign wherever it is typed, like in Blender
+	if (InKey == EKeys::Hyphen || InKey == EKeys::Subtract)
+	{
+		bNegative = !bNegative;
+		return true;
+	}
+
+	// Backspace is only consumed while there is something to erase
+	if (InKey == EKeys::BackSpace && IsActive())
+	{
+		if (Digits.IsEmpty())
+		{
+			bNegative = false;
+		}
+		else
+		{
+			Digits.LeftChopInline(1);
+		}
+		return true;
+	}
+
+	return false;
+}
+
+float FToolNumericInput::GetValue() const
+{
+	const float Value = FCString::Atof(*Digits);
+	return bNegative ? -Value : Value;
+}
+
+FString FToolNumericInput::ToString() const
+{
+	return FString::Printf(TEXT("%s%s"), bNegative ? TEXT("-") : TEXT(""), Digits.IsEmpty() ? TEXT("0") : *Digits);
+}
+
+/**
+ * Outline Tint
+ */
+void FToolOutlineTint::Apply(int32 InNumSelectedActors)
+{
+	SCOPE_CYCLE_COUNTER(STAT_BlenderViewportControls_OutlineTint);
+
+	const int32 MaxActors = CVarOutlineTintMaxActors.GetValueOnGameThread();
+	if (SavedColor.IsSet() || MaxActors <= 0 || InNumSelectedActors > MaxActors)
+	{
+		return;
+	}
+
+	const FLinearColor CurrentColor = GEditor->GetSelectionOutlineColor();
+	if (CurrentColor.Equals(ToolOutlineColor))
+	{
+		return;
+	}
+
+	SavedColor = CurrentColor;
+	GEditor->SetSelectionOutlineColor(ToolOutlineColor);
+}
+
+void FToolOutlineTint::Restore()
+{
+	SCOPE_CYCLE_COUNTER(STAT_BlenderViewportControls_OutlineTint);
+
+	if (SavedColor.IsSet())
+	{
+		GEditor->SetSelectionOutlineColor(SavedColor.GetValue());
+		SavedColor.Reset();
+	}
+}
+
+void FToolGroupSource::Capture(const TArray<AActor*>& InActors)
+{
+	Actors = InActors;
+	WeakActors.Reset(InActors.Num());
+	Transforms.Reset(InActors.Num());
+
+	for (AActor* Actor : InActors)
+	{
+		WeakActors.Add(Actor);
+		Transforms.Add(Actor->GetTransform());
+	}
+}
+
+TArray<int32> FToolGroupSource::GetRootIndices() const
+{
+	// The actors stay alive while the attach parents are read, attachments don't change while a tool is running
+	FGCScopeGuard GCGuard;
+
+	TSet<const AActor*> ActorSet;
+	ActorSet.Reserve(Actors.Num());
+	for (const AActor* Actor : Actors)
+	{
+		ActorSet.Add(Actor);
+	}
+
+	// An actor is only a root if none of its ancestors are part of the set
+	TArray<int32> RootIndices;
+	RootIndices.Reserve(Actors.Num());
+	for (int32 ActorIndex = 0; ActorIndex < Actors.Num(); ++ActorIndex)
+	{
+		// Actors deleted since the capture are kept without reading them, the tool drops them when the group is ready
+		bool bHasSelectedAncestor = false;
+		if (WeakActors[ActorIndex].IsValid())
+		{
+			for (const AActor* AttachParent = Actors[ActorIndex]->GetAttachParentActor(); AttachParent; AttachParent = AttachParent->GetAttachParentActor())
+			{
+				if (ActorSet.Contains(AttachParent))
+				{
+					bHasSelectedAncestor = true;
+					break;
+				}
+			}
+		}
+
+		if (!bHasSelectedAncestor)
+		{
+			RootIndices.Add(ActorIndex);
+		}
+	}
+
+	return RootIndices;
+}
+
+/** Builds the group of a tool. Only works on the captured source and a copy of the projection, so it can run on a worker thread */
+static FToolGroupBuild BuildToolGroup(const FToolGroupSource& InSource, const UWorld* InWorld, EToolPivotMode InPivotMode, const FViewportProjection& InProjection, const FIntPoint& InCursorPosition)
+{
+	FToolGroupBuild Build;
+	Build.Group = MakeShared<FGroupTransform>();
+
+	const TArray<int32> RootIndices = InSource.GetRootIndices();
+	Build.NumSkippedAttachedActors = InSource.Actors.Num() - RootIndices.Num();
+	Build.ChildWeakActors.Reserve(RootIndices.Num());
+	for (const int32 ActorIndex : RootIndices)
+	{
+		Build.Group->AddChild(InSource.Actors[ActorIndex], InSource.Transforms[ActorIndex]);
+		Build.ChildWeakActors.Add(InSource.WeakActors[ActorIndex]);
+	}
+
+	Build.Group->SetPivotMode(InPivotMode);
+	Build.Group->FinishSetup(InWorld, InProjection, InCursorPosition);
+
+	return Build;
+}
+
 /**
  * Base Implementation of the FBlenderToolMode
  */
 void FBlenderToolMode::ToolBegin()
 {
+	if (ToolActors.Num() == 0)
+	{
+		ToolActors = ToolHelperFunctions::GetSelectedLevelActors();
+	}
+
 	// Change the selection outline color when in ToolMode
-	DefaultSelectionOutlineColor = GEditor->GetSelectionOutlineColor();
-	GEditor->SetSelectionOutlineColor(FLinearColor::White);	
+	OutlineTint.Apply(ToolActors.Num());
 
-	// Create a new GroupTransform for this tool
-	GroupTransform = MakeShared<FGroupTransform>();
+	// The worker only gets copies, the actors can be deleted or unloaded while the group is built
+	FToolGroupSource GroupSource;
+	GroupSource.Capture(ToolActors);
 
-	USelection* CurrentSelection = GEditor->GetSelectedActors();
-	for (FSelectionIterator Iter(*CurrentSelection); Iter; ++Iter)
+	const int32 ProgressiveMinActors = CVarProgressiveStartupMinActors.GetValueOnGameThread();
+	if (ProgressiveMinActors > 0 && ToolActors.Num() >= ProgressiveMinActors)
 	{
-		if (AActor* LevelActor = Cast<AActor>(*Iter))
-		{
-			SelectionInfos.Add(FSelectionToolHelper(LevelActor, LevelActor->GetTransform()));
+		// The editor keeps the pivot of the selection up to date anyway, so the tool can follow the cursor from the first frame
+		GroupTransform = MakeShared<FGroupTransform>();
+		GroupTransform->SetupEstimate(ToolViewportClient, GEditor->GetPivotLocation());
+
+		bGroupPending = true;
+		PendingGroup = UE::Tasks::Launch(UE_SOURCE_LOCATION,
+			[Source = MoveTemp(GroupSource), World = ToolViewportClient->GetWorld(), PivotMode = SavedPivotMode,
+			Projection = ToolHelperFunctions::GetViewportProjection(ToolViewportClient), CursorPosition = GetCursorPosition()]()
+			{
+				return BuildToolGroup(Source, World, PivotMode, Projection, CursorPosition);
+			});
+
+		UE_LOG(LogBlenderTool, Verbose, TEXT("%s: Building the group of %d actors on a worker thread"), *OperationName.ToString(), ToolActors.Num());
+	}
+	else
+	{
+		FToolGroupBuild Build = BuildToolGroup(GroupSource, ToolViewportClient->GetWorld(), SavedPivotMode, ToolHelperFunctions::GetViewportProjection(ToolViewportClient), GetCursorPosition());
+		GroupTransform = Build.Group;
+		NumSkippedAttachedActors = Build.NumSkippedAttachedActors;
 
-			FIntPoint ActorScreenLocation = ToolHelperFunctions::ProjectWorldLocationToScreen(ToolViewportClient, LevelActor->GetActorLocation());
-			FIntPoint ScreenSpaceOffset = GetCursorPosition() - ActorScreenLocation;
+		if (NumSkippedAttachedActors > 0)
+		{
+			UE_LOG(LogBlenderTool, Log, TEXT("%s: Skipped %d actors that are attached to another selected actor"), *OperationName.ToString(), NumSkippedAttachedActors);
+		}
 
-			GroupTransform->AddChild(LevelActor, ScreenSpaceOffset);
+		if (bSavedProportionalEditing)
+		{
+			UpdateProportionalEditing();
 		}
 	}
-	GroupTransform->FinishSetup(ToolViewportClient);
+
+	// Editor reactions to the movement are held back until the operation is accepted
+	DragSession = MakeUnique<FToolDragSession>(ToolViewportClient->GetWorld());
+
+	if (FToolPerfStats::IsEnabled())
+	{
+		UndoSizeBeforeTool = ToolHelperFunctions::GetUndoBufferSize();
+	}
 
 	// Start Parent Transaction
 	GEditor->BeginTransaction(OperationName);
@@ -49,24 +378,237 @@ void FBlenderToolMode::ToolBegin()
 
 void FBlenderToolMode::ToolClose(bool Success /*= true*/)
 {
+	// Accepting before the group is ready still applies what was input so far. 
+	// Cancelling throws the group away, nothing was written to the actors yet, so there is nothing to restore either
+	if (bGroupPending)
+	{
+		PendingGroup.Wait();
+		if (Success)
+		{
+			OnGroupReady();
+		}
+		else
+		{
+			PendingGroup = UE::Tasks::TTask<FToolGroupBuild>();
+			bGroupPending = false;
+		}
+	}
+
 	// Reset the selection outline color
-	GEditor->SetSelectionOutlineColor(DefaultSelectionOutlineColor);
+	OutlineTint.Restore();
+
+	// PostEditMove can rerun construction scripts, so it has to happen while the transaction is still open
+	if (Success && DragSession)
+	{
+		DragSession->Commit(GroupTransform->GetAllAffectedActors());
+	}
 
 	// Ends the child transaction
 	GEditor->EndTransaction();
 
 	if (!Success)
 	{
-		for (auto& Info : SelectionInfos)
+		// The transaction recorded the children and the proportionally edited actors before they were first written, applying it restores them exactly.
+		// Actors it could not record (no transaction, not transactional) kept their original transforms in the group
+		if (GUndo)
 		{
-			Info.Actor->SetActorTransform(Info.DefaultTransform);
+			GUndo->Apply();
 		}
+		GroupTransform->RestoreUnrecordedActors();
 
 		GEditor->CancelTransaction(0);
 	}
 
 	// End the parent transaction so we can undo it.
 	GEditor->EndTransaction();
+
+	DragSession.Reset();
+}
+
+void FBlenderToolMode::ToolTick()
+{
+	if (bGroupPending && PendingGroup.IsCompleted())
+	{
+		OnGroupReady();
+	}
+
+	// The typed value was applied when it changed, the overlay keeps drawing from the tool state
+	if (IsNumericInputActive())
+	{
+		return;
+	}
+
+	if (!FToolPerfStats::IsEnabled())
+	{
+		ToolUpdate();
+		return;
+	}
+
+	FToolPerfStats& PerfStats = FToolPerfStats::Get();
+	PerfStats.BeginFrame();
+
+	const double StartSeconds = FPlatformTime::Seconds();
+	ToolUpdate();
+	PerfStats.EndFrame(FPlatformTime::Seconds() - StartSeconds);
+}
+
+FToolInputState FBlenderToolMode::GetInputState() const
+{
+	return FToolInputState::Get(ToolViewportClient);
+}
+
+void FBlenderToolMode::SetViewportClient(FEditorViewportClient* InViewportClient)
+{
+	if (InViewportClient == ToolViewportClient)
+	{
+		return;
+	}
+
+	// Screen space state of the previous viewport means nothing in the new one, the operation continues from where the cursor enters
+	ToolViewportClient = InViewportClient;
+	GroupTransform->UpdateScreenSpace(ToolViewportClient, GetCursorPosition());
+	ReanchorCursor();
+
+	bViewportChangedWhilePending |= bGroupPending;
+
+	UE_LOG(LogBlenderTool, Verbose, TEXT("%s: Continued in another viewport"), *OperationName.ToString());
+}
+
+void FBlenderToolMode::DrawHUD(FEditorViewportClient* ViewportClient, FViewport* Viewport, const FSceneView* View, FCanvas* Canvas)
+{
+	FToolOverlayState OverlayState;
+	BuildOverlayState(OverlayState);
+
+	Overlay.Update(OverlayState);
+	Overlay.SetReadout(GetReadout());
+	Overlay.Draw(Canvas);
+}
+
+void FBlenderToolMode::DrawPerfOverlay(FCanvas* Canvas)
+{
+	// The overlay was turned on during the operation, the undo size counts from here
+	if (!UndoSizeBeforeTool.IsSet())
+	{
+		UndoSizeBeforeTool = ToolHelperFunctions::GetUndoBufferSize();
+	}
+
+	const SIZE_T UndoSize = ToolHelperFunctions::GetUndoBufferSize();
+	const uint64 UndoBytes = UndoSize > UndoSizeBeforeTool.GetValue() ? UndoSize - UndoSizeBeforeTool.GetValue() : 0;
+
+	FToolPerfStats::Get().Draw(Canvas, OperationName.ToString(), GroupTransform->GetNumChildren(), UndoBytes);
+}
+
+void FBlenderToolMode::BuildOverlayState(FToolOverlayState& OutState) const
+{
+	OutState.CursorPosition = GetCursorPosition();
+	OutState.PivotPosition = ToolHelperFunctions::ProjectWorldLocationToScreen(ToolViewportClient, GroupTransform->GetOriginLocation());
+	OutState.bDrawPivot = true;
+
+	// The axis guides go through the origin at the time the lock was set
+	const FVector LockOrigin = AxisLockHelper.TransformWhenLocked.GetLocation();
+	for (const FAxisLineDrawHelper& AxisLine : AxisLineDrawHelper)
+	{
+		FToolOverlayAxis Axis;
+		if (ToolHelperFunctions::ProjectWorldLineToScreen(ToolViewportClient, LockOrigin, AxisLine.LineDirection, Axis.Start, Axis.End))
+		{
+			Axis.Color = AxisLine.LineColor;
+			OutState.Axes.Add(Axis);
+		}
+	}
+}
+
+FString FBlenderToolMode::GetReadout() const
+{
+	return NumericInput.IsActive() ? NumericInput.ToString() : FString();
+}
+
+bool FBlenderToolMode::HandleNumericInput(const FKey& InKey)
+{
+	const bool bWasActive = NumericInput.IsActive();
+	if (!NumericInput.HandleKey(InKey))
+	{
+		return false;
+	}
+
+	if (NumericInput.IsActive())
+	{
+		ApplyNumericInput(NumericInput.GetValue());
+	}
+	else if (bWasActive)
+	{
+		ResumeCursorInput();
+	}
+
+	return true;
+}
+
+void FBlenderToolMode::RefreshNumericInput()
+{
+	if (NumericInput.IsActive())
+	{
+		ApplyNumericInput(NumericInput.GetValue());
+	}
+}
+
+void FBlenderToolMode::OnGroupReady()
+{
+	FToolGroupBuild Build = MoveTemp(PendingGroup.GetResult());
+	PendingGroup = UE::Tasks::TTask<FToolGroupBuild>();
+	bGroupPending = false;
+
+	GroupTransform = Build.Group;
+	NumSkippedAttachedActors = Build.NumSkippedAttachedActors;
+	if (NumSkippedAttachedActors > 0)
+	{
+		UE_LOG(LogBlenderTool, Log, TEXT("%s: Skipped %d actors that are attached to another selected actor"), *OperationName.ToString(), NumSkippedAttachedActors);
+	}
+
+	// Actors deleted or unloaded while the group was built are dropped before anything is written to them
+	TArray<int32> InvalidChildIndices;
+	for (int32 ChildIndex = 0; ChildIndex < Build.ChildWeakActors.Num(); ++ChildIndex)
+	{
+		if (!Build.ChildWeakActors[ChildIndex].IsValid())
+		{
+			InvalidChildIndices.Add(ChildIndex);
+		}
+	}
+
+	if (InvalidChildIndices.Num() > 0)
+	{
+		GroupTransform->RemoveChildren(InvalidChildIndices);
+		UE_LOG(LogBlenderTool, Log, TEXT("%s: Dropped %d actors that were removed while the group was built"), *OperationName.ToString(), InvalidChildIndices.Num());
+	}
+
+	if (bViewportChangedWhilePending)
+	{
+		GroupTransform->UpdateScreenSpace(ToolViewportClient, GetCursorPosition());
+		bViewportChangedWhilePending = false;
+	}
+
+	if (bSavedProportionalEditing)
+	{
+		UpdateProportionalEditing();
+	}
+
+	// The axis guides went through the estimated pivot
+	if (AxisLockHelper.IsLocked())
+	{
+		AxisLockHelper.TransformWhenLocked = GroupTransform->GetParentTransform();
+		AxisLineDrawHelper.Empty();
+		CalculateAxisLock();
+	}
+
+	// The tools keep their input as deltas from the original transforms, so it applies to the real group the same way it applied to the estimate
+	if (IsNumericInputActive())
+	{
+		RefreshNumericInput();
+	}
+	else
+	{
+		ResumeCursorInput();
+	}
+
+	UE_LOG(LogBlenderTool, Verbose, TEXT("%s: Group of %d children is ready"), *OperationName.ToString(), GroupTransform->GetNumChildren());
 }
 
 void FBlenderToolMode::CalculateAxisLock()
@@ -146,15 +688,6 @@ void FBlenderToolMode::CalculateAxisLock()
 	}
 }
 
-void FBlenderToolMode::DrawAxisLocks()
-{
-	const UWorld* World = ToolViewportClient->GetWorld();
-	for (const auto& AxisLine : AxisLineDrawHelper)
-	{
-		ToolHelperFunctions::DrawAxisLine(World, AxisLockHelper.TransformWhenLocked.GetLocation(), AxisLine.LineDirection, AxisLine.LineColor);
-	}
-}
-
 void FBlenderToolMode::SetAxisLock(const EToolAxisLock& InAxisToLock, bool bDualAxis)
 {
 	// Remove the lines we are currently drawing
@@ -174,6 +707,9 @@ void FBlenderToolMode::SetAxisLock(const EToolAxisLock& InAxisToLock, bool bDual
 	AxisLockHelper.CurrentLockedAxis = InAxisToLock;
 	AxisLockHelper.IsDualAxisLock = bDualAxis;
 	AxisLockHelper.TransformWhenLocked = GetGroupTransform()->GetParentTransform();
+
+	// The lock vectors only depend on the lock state and the group rotation, so they are resolved here instead of every frame
+	CalculateAxisLock();
 }
 
 void FBlenderToolMode::AddSnapOffset(const float InOffset)
@@ -181,13 +717,63 @@ void FBlenderToolMode::AddSnapOffset(const float InOffset)
 	SavedSnapOffset += InOffset;
 }
 
-/**
+float FBlenderToolMode::GetSnapOffset()
+{
+	return SavedSnapOffset;
+}
+
+bool FBlenderToolMode::IsProportionalEditing()
+{
+	return bSavedProportionalEditing;
+}
+
+void FBlenderToolMode::SetProportionalEditing(bool bEnabled)
+{
+	bSavedProportionalEditing = bEnabled;
+}
+
+EToolPivotMode FBlenderToolMode::GetPivotMode()
+{
+	return SavedPivotMode;
+}
+
+void FBlenderToolMode::SetPivotMode(EToolPivotMode InPivotMode)
+{
+	SavedPivotMode = InPivotMode;
+}
+
+void FBlenderToolMode::AddProportionalRadius(float InSteps)
+{
+	SavedProportionalRadius = FMath::Max(SavedProportionalRadius * FMath::Pow(ProportionalRadiusStep, InSteps), 1.f);
+	UpdateProportionalEditing();
+}
+
+void FBlenderToolMode::UpdateProportionalEditing()
+{
+	// Picked up by OnGroupReady, there are no children to measure the distances to yet
+	if (bGroupPending)
+	{
+		return;
+	}
+
+	if (bSavedProportionalEditing)
+	{
+		GroupTransform->SetProportionalRadius(SavedProportionalRadius);
+	}
+	else
+	{
+		GroupTransform->ClearProportionalChildren();
+	}
+}
+
+/**
  * Move Tool Implementation
  */
 void FMoveMode::ToolBegin()
 {
 	UE_LOG(LogMoveTool, Verbose, TEXT("Begin"));
 
+	SelectKernel();
 	LastFrameCursorPosition = GetIntersection();
 
 	// Begins the child transaction
@@ -196,13 +782,21 @@ void FMoveMode::ToolBegin()
 
 void FMoveMode::ToolUpdate()
 {
-	CalculateAxisLock();
+	// The input is sampled once per frame, the lock state was resolved into the update function when it changed
+	(this->*ActiveUpdate)(GetInputState());
+}
+
+template<EMoveKernel Kernel>
+void FMoveMode::UpdateKernel(const FToolInputState& InInput)
+{
+	const bool bSurfaceSnapping = InInput.bCtrlDown && IsSurfaceSnapTarget();
+	const bool bIncrementSnapping = InInput.bCtrlDown && !IsSurfaceSnapTarget();
 
-	FVector NewLocation = GetIntersection();
+	FVector NewLocation = GetIntersectionKernel<Kernel>(InInput.CursorPosition);
 
 	// Single Axis Locking
 	FVector LockedLocation = NewLocation;
-	if (!AxisLockHelper.IsDualAxisLock && AxisLockHelper.CurrentLockedAxis != None)
+	if constexpr (Kernel == EMoveKernel::Axis)
 	{
 		LockedLocation = UKismetMathLibrary::FindClosestPointOnLine(LockedLocation, GroupTransform->GetOriginLocation(), AxisLockHelper.LockVector);
 
@@ -214,51 +808,221 @@ void FMoveMode::ToolUpdate()
 		}
 	}
 
-	// Draw the visual axis locking lines in the viewport
-	DrawAxisLocks();
+	FVector SnapPoint;
+	// Snapping needs the children, the snap points would include them and surface snapping snaps each child on its own
+	if (InInput.bAltDown && !bSurfaceSnapping && IsGroupReady() && FindSnapPoint(InInput.CursorPosition, SnapPoint))
+	{
+		const FVector OriginalLocation = GroupTransform->GetOriginalOriginLocation();
+
+		// Keep the snapped origin on the locked axis or plane
+		if constexpr (Kernel == EMoveKernel::Axis)
+		{
+			SnapPoint = UKismetMathLibrary::FindClosestPointOnLine(SnapPoint, OriginalLocation, AxisLockHelper.LockVector);
+		}
+		else if constexpr (Kernel == EMoveKernel::Plane)
+		{
+			SnapPoint = FVector::PointPlaneProject(SnapPoint, OriginalLocation, AxisLockHelper.LockPlaneNormal);
+		}
 
+		// Continue from the snapped location once snapping is released
+		AccumulatedOffset = SnapPoint - OriginalLocation;
+		GroupTransform->SetLocation(SnapPoint);
+	}
 	// Surface Snap mode
-	if (IsSurfaceSnapping())
-	{
-		// Surface Snap snaps individual children and doesn't care about the GroupTransform
-		TArray<AActor*> IgnoredActors = GroupTransform->GetAllChildActors();
-		for (auto& Child : GroupTransform->GetChildren())
-		{
-			FIntPoint ChildScreenLocation = Child.ScreenSpaceOffset + (GetCursorPosition() + GroupTransform->GetScreenSpaceOffset());
-			TTuple<FVector, FVector> Test = ToolHelperFunctions::ProjectScreenPositionToWorld(ToolViewportClient, ChildScreenLocation);
-			FVector TraceStart = Test.Get<0>();
-			FVector TraceEnd = Test.Get<1>() * 10000.f;
-			FHitResult OutHit;
-			FCollisionQueryParams QueryParams;
-			QueryParams.bTraceComplex = true;
-			QueryParams.AddIgnoredActors(IgnoredActors);
-			if (ToolViewportClient->GetWorld()->LineTraceSingleByChannel(OutHit, TraceStart, TraceEnd, ECC_Visibility, QueryParams))
-			{
-				if (OutHit.bBlockingHit)
-				{
-					// New Location
-					FVector NewLocWithSnapOffset = OutHit.ImpactPoint + (OutHit.ImpactNormal * SavedSnapOffset);
-					Child.Actor->SetActorLocation(NewLocWithSnapOffset);
+	else if (bSurfaceSnapping)
+	{
+		// Surface Snap snaps individual children and doesn't care about the GroupTransform.
+		// All children are traced in one batch, then the ones that hit something are aligned in one batch.
+		const TArray<AActor*>& ChildActors = GroupTransform->GetAllChildActors();
+		const TArray<FIntPoint>& ChildScreenSpaceOffsets = GroupTransform->GetChildScreenSpaceOffsets();
+		const FIntPoint CursorOffset = InInput.CursorPosition + GroupTransform->GetScreenSpaceOffset();
+
+		TArray<FVector> TraceStarts;
+		TArray<FVector> TraceEnds;
+		TraceStarts.Reserve(ChildActors.Num());
+		TraceEnds.Reserve(ChildActors.Num());
+		for (const FIntPoint& ChildScreenSpaceOffset : ChildScreenSpaceOffsets)
+		{
+			const TTuple<FVector, FVector> ChildRay = ToolHelperFunctions::ProjectScreenPositionToWorld(ToolViewportClient, ChildScreenSpaceOffset + CursorOffset);
+			TraceStarts.Add(ChildRay.Get<0>());
+			TraceEnds.Add(ChildRay.Get<0>() + ChildRay.Get<1>() * SurfaceSnapTraceDistance);
+		}
 
-					// New Rotation
-					FQuat SurfaceAlignedRotation = ToolHelperFunctions::FindActorAlignmentRotation(Child.Actor->GetActorRotation().Quaternion(), FVector(0.f, 0.f, 1.f), OutHit.ImpactNormal);
-					Child.Actor->SetActorRotation(SurfaceAlignedRotation);
-				}
+		TArray<FHitResult> Hits;
+		{
+			FToolPerfScope PerfScope(EToolPerfCategory::SnapTraces);
+			ToolHelperFunctions::LineTraceBatch(ToolViewportClient->GetWorld(), TraceStarts, TraceEnds, GroupTransform->GetAllAffectedActors(), Hits);
+			FToolPerfStats::Get().AddTraces(TraceStarts.Num());
+		}
+
+		// Children that hit nothing keep their current transform
+		TArray<FTransform> SnapTransforms;
+		SnapTransforms.Reserve(ChildActors.Num());
+		for (const AActor* ChildActor : ChildActors)
+		{
+			SnapTransforms.Add(ChildActor->GetActorTransform());
+		}
+
+		TArray<int32> HitChildIndices;
+		TArray<FQuat> HitRotations;
+		TArray<FVector> HitNormals;
+		for (int32 ChildIndex = 0; ChildIndex < ChildActors.Num(); ++ChildIndex)
+		{
+			if (Hits[ChildIndex].bBlockingHit)
+			{
+				HitChildIndices.Add(ChildIndex);
+				HitRotations.Add(SnapTransforms[ChildIndex].GetRotation());
+				HitNormals.Add(Hits[ChildIndex].ImpactNormal);
 			}
 		}
+
+		TArray<FQuat> AlignedRotations;
+		ToolHelperFunctions::FindActorAlignmentRotations(HitRotations, FVector(0.f, 0.f, 1.f), HitNormals, AlignedRotations);
+
+		for (int32 HitIndex = 0; HitIndex < HitChildIndices.Num(); ++HitIndex)
+		{
+			const FHitResult& Hit = Hits[HitChildIndices[HitIndex]];
+			FTransform& SnapTransform = SnapTransforms[HitChildIndices[HitIndex]];
+			SnapTransform.SetLocation(Hit.ImpactPoint + Hit.ImpactNormal * SavedSnapOffset);
+			SnapTransform.SetRotation(AlignedRotations[HitIndex]);
+		}
+
+		// The same batched write back as every other operation, so the children are recorded and proportionally edited actors follow
+		GroupTransform->SetTransforms(SnapTransforms, ETransformComponents::Location | ETransformComponents::Rotation);
 	}
 	else
 	{
 		// Precision mode scalar
-		float PrecisionModeScalar = IsPrecisionModeActive() ? 0.1f : 1.f;
+		float PrecisionModeScalar = InInput.bShiftDown ? 0.1f : 1.f;
+		AccumulatedOffset += (LockedLocation - LastFrameCursorPosition) * PrecisionModeScalar;
+
+		// Snapping works on the accumulated offset, otherwise small precision mode steps would never reach the next increment
+		FVector Offset = AccumulatedOffset;
+		if (bIncrementSnapping)
+		{
+			const FVector OriginalLocation = GroupTransform->GetOriginalOriginLocation();
+			const FQuat LocalRotation = GroupTransform->GetParentTransform().GetRotation();
+
+			// Relative increments along the world axes would pull an offset along a local axis lock off that axis
+			EToolSnapMode SnapMode = ToolSnapping::GetSnapMode();
+			if (SnapMode == EToolSnapMode::RelativeIncrement && Kernel != EMoveKernel::Free && !AxisLockHelper.IsWorldSpace)
+			{
+				SnapMode = EToolSnapMode::LocalGrid;
+			}
+
+			Offset = ToolSnapping::SnapOffset(AccumulatedOffset, OriginalLocation, LocalRotation, GEditor->GetGridSize(), SnapMode);
+		}
 
 		// Set the final position
-		GroupTransform->AddLocation((LockedLocation - LastFrameCursorPosition) * PrecisionModeScalar);
+		GroupTransform->SetLocation(GroupTransform->GetOriginalOriginLocation() + Offset);
 	}
 
 	LastFrameCursorPosition = LockedLocation;
 }
 
+void FMoveMode::BuildSnapPointGrid()
+{
+	TSet<const AActor*> IgnoredActors;
+	for (AActor* Actor : GroupTransform->GetAllChildActors())
+	{
+		TArray<AActor*> AttachedActors;
+		Actor->GetAttachedActors(AttachedActors, true, true);
+
+		IgnoredActors.Add(Actor);
+		IgnoredActors.Append(AttachedActors);
+	}
+
+	const bool bSnapToVertices = CVarSnapToVertices.GetValueOnGameThread();
+
+	TArray<FVector> SnapPoints;
+	for (TActorIterator<AActor> It(ToolViewportClient->GetWorld()); It; ++It)
+	{
+		AActor* Actor = *It;
+		if (IgnoredActors.Contains(Actor) || Actor->IsHiddenEd() || !Actor->GetRootComponent())
+		{
+			continue;
+		}
+
+		SnapPoints.Add(Actor->GetActorLocation());
+
+		if (!bSnapToVertices)
+		{
+			continue;
+		}
+
+		// Instanced components only have a single component transform, so their vertices can't be placed without the instance transforms
+		TInlineComponentArray<UStaticMeshComponent*> MeshComponents(Actor);
+		for (const UStaticMeshComponent* MeshComponent : MeshComponents)
+		{
+			const UStaticMesh* StaticMesh = MeshComponent->GetStaticMesh();
+			if (MeshComponent->IsA<UInstancedStaticMeshComponent>() || !StaticMesh || !StaticMesh->GetRenderData() || StaticMesh->GetRenderData()->LODResources.Num() == 0)
+			{
+				continue;
+			}
+
+			const FTransform& ComponentTransform = MeshComponent->GetComponentTransform();
+			const FPositionVertexBuffer& PositionBuffer = StaticMesh->GetRenderData()->LODResources[0].VertexBuffers.PositionVertexBuffer;
+			for (uint32 VertexIndex = 0; VertexIndex < PositionBuffer.GetNumVertices(); ++VertexIndex)
+			{
+				SnapPoints.Add(ComponentTransform.TransformPosition(FVector(PositionBuffer.VertexPosition(VertexIndex))));
+			}
+		}
+	}
+
+	SnapPointGrid.Build(MoveTemp(SnapPoints), SnapPointGridCellSize);
+}
+
+bool FMoveMode::FindSnapPoint(const FIntPoint& InCursorPosition, FVector& OutSnapPoint)
+{
+	FToolPerfScope PerfScope(EToolPerfCategory::SnapTraces);
+
+	if (!SnapPointGrid.IsBuilt())
+	{
+		BuildSnapPointGrid();
+	}
+
+	TTuple<FVector, FVector> WorldLocDir = ToolHelperFunctions::ProjectScreenPositionToWorld(ToolViewportClient, InCursorPosition);
+	const FVector RayOrigin = WorldLocDir.Get<0>();
+	const FVector RayDirection = WorldLocDir.Get<1>();
+
+	// The screen space snap radius is a cone around the cursor ray in perspective views and a cylinder in orthographic ones
+	float SearchRadius = 0.f;
+	float SearchRadiusPerDistance = 0.f;
+	if (ToolViewportClient->IsPerspective())
+	{
+		const float ViewWidth = FMath::Max(ToolViewportClient->Viewport->GetSizeXY().X, 1);
+		SearchRadiusPerDistance = FMath::Tan(FMath::DegreesToRadians(ToolViewportClient->ViewFOV * 0.5f)) * 2.f * SnapPointScreenRadius / ViewWidth;
+	}
+	else
+	{
+		SearchRadius = ToolViewportClient->GetOrthoUnitsPerPixel(ToolViewportClient->Viewport) * SnapPointScreenRadius;
+	}
+
+	const int32 PointIndex = SnapPointGrid.FindNearestToRay(RayOrigin, RayDirection, SearchRadius, SearchRadiusPerDistance);
+	if (PointIndex == INDEX_NONE)
+	{
+		return false;
+	}
+
+	OutSnapPoint = SnapPointGrid.GetPoint(PointIndex);
+	return true;
+}
+
+bool FMoveMode::IsSurfaceSnapTarget()
+{
+	return CVarMoveSnapTarget.GetValueOnGameThread() == 0;
+}
+
+bool FMoveMode::IsSurfaceSnapping() const
+{
+	return GetInputState().bCtrlDown && IsSurfaceSnapTarget();
+}
+
+bool FMoveMode::IsIncrementSnapping() const
+{
+	return GetInputState().bCtrlDown && !IsSurfaceSnapTarget();
+}
+
 void FMoveMode::ToolClose(bool Success)
 {
 	FBlenderToolMode::ToolClose(Success);
@@ -270,14 +1034,81 @@ void FMoveMode::SetAxisLock(const EToolAxisLock& InAxisToLock, bool bDualAxis)
 {
 	FBlenderToolMode::SetAxisLock(InAxisToLock, bDualAxis);
 
+	SelectKernel();
+
 	// We set this to true again so the axis locking works correctly for this mode
 	bForceAxisLockLastFrameUpdate = true;
 }
 
+void FMoveMode::SelectKernel()
+{
+	if (!AxisLockHelper.IsLocked())
+	{
+		ActiveKernel = EMoveKernel::Free;
+		ActiveUpdate = &FMoveMode::UpdateKernel<EMoveKernel::Free>;
+	}
+	else if (AxisLockHelper.IsDualAxisLock)
+	{
+		ActiveKernel = EMoveKernel::Plane;
+		ActiveUpdate = &FMoveMode::UpdateKernel<EMoveKernel::Plane>;
+	}
+	else
+	{
+		ActiveKernel = EMoveKernel::Axis;
+		ActiveUpdate = &FMoveMode::UpdateKernel<EMoveKernel::Axis>;
+	}
+}
+
+void FMoveMode::ApplyNumericInput(float InValue)
+{
+	// Plane locks move along one of the plane axes, free moves along world X
+	const FVector Direction = AxisLockHelper.IsLocked() ? AxisLockHelper.LockVector : FVector::ForwardVector;
+	GroupTransform->SetLocation(GroupTransform->GetOriginalOriginLocation() + Direction * InValue);
+}
+
+void FMoveMode::ResumeCursorInput()
+{
+	// Go back to where the cursor left the group, the intersection plane goes through the group origin
+	GroupTransform->SetLocation(GroupTransform->GetOriginalOriginLocation() + AccumulatedOffset);
+
+	ReanchorCursor();
+}
+
+void FMoveMode::ReanchorCursor()
+{
+	LastFrameCursorPosition = GetIntersection();
+	bForceAxisLockLastFrameUpdate = true;
+}
+
+FString FMoveMode::GetReadout() const
+{
+	if (IsNumericInputActive())
+	{
+		return FBlenderToolMode::GetReadout();
+	}
+
+	const FVector Offset = GroupTransform->GetOriginLocation() - GroupTransform->GetOriginalOriginLocation();
+	return FString::Printf(TEXT("%.1f  %.1f  %.1f"), Offset.X, Offset.Y, Offset.Z);
+}
+
 FVector FMoveMode::GetIntersection() const
 {
+	// Axis locks intersect the same camera facing plane as free moves
+	if (ActiveKernel == EMoveKernel::Plane)
+	{
+		return GetIntersectionKernel<EMoveKernel::Plane>(GetCursorPosition());
+	}
+
+	return GetIntersectionKernel<EMoveKernel::Free>(GetCursorPosition());
+}
+
+template<EMoveKernel Kernel>
+FVector FMoveMode::GetIntersectionKernel(const FIntPoint& InCursorPosition) const
+{
+	FToolPerfScope PerfScope(EToolPerfCategory::Intersection);
+
 	// Trace from the cursor onto a plane and get the intersection
-	TTuple<FVector, FVector> WorldLocDir = ToolHelperFunctions::ProjectScreenPositionToWorld(ToolViewportClient, GetCursorPosition());
+	TTuple<FVector, FVector> WorldLocDir = ToolHelperFunctions::ProjectScreenPositionToWorld(ToolViewportClient, InCursorPosition);
 	const FVector TransformWorldPosition = WorldLocDir.Get<0>();
 	const FVector TransformWorldDirection = WorldLocDir.Get<1>();
 
@@ -286,7 +1117,7 @@ FVector FMoveMode::GetIntersection() const
 	LinePlaneCameraHelper.TraceStartLocation = TransformWorldPosition;
 	LinePlaneCameraHelper.TraceDirection = TransformWorldDirection;
 	LinePlaneCameraHelper.PlaneNormal = GetCameraForwardVector();
-	if (AxisLockHelper.IsDualAxisLock && AxisLockHelper.CurrentLockedAxis != None)
+	if constexpr (Kernel == EMoveKernel::Plane)
 	{
 		LinePlaneCameraHelper.PlaneNormal = AxisLockHelper.LockPlaneNormal;
 	}
@@ -306,54 +1137,67 @@ void FRotateMode::ToolBegin()
 	// Begins the child transaction
 	GEditor->BeginTransaction(FText());
 
+	SelectKernel();
+
 	FVector CursorIntersection = GetIntersection();
 	LastUpdateMouseRotVector = (CursorIntersection - GroupTransform->GetOriginLocation()).GetSafeNormal();
 }
 
 void FRotateMode::ToolUpdate()
 {
-	CalculateAxisLock();
-
-	FVector CursorIntersection = GetIntersection();
-	FVector currentRotVector = (CursorIntersection - GroupTransform->GetOriginLocation()).GetSafeNormal();
+	// The input is sampled once per frame, the lock and trackball state was resolved into the update function when it changed
+	(this->*ActiveUpdate)(GetInputState());
+}
 
-	// Gives us the degrees between the cursor starting position and end position in -180 - 180;
-	float RotationAngle = UKismetMathLibrary::DegAcos(FVector::DotProduct(currentRotVector, LastUpdateMouseRotVector));
+template<ERotateKernel Kernel>
+void FRotateMode::UpdateKernel(const FToolInputState& InInput)
+{
+	FVector CursorIntersection = GetIntersection(InInput.CursorPosition);
 
-	// First check if the camera is looking down or up and flips. Otherwise dragging the mouse left would rotate the object
-	// to the right whenever we are looking from below. (Hard to explain, just uncomment the first "if" statement to see the behavior.
-	if (ToolViewportClient->GetViewRotation().Vector().Z > 0)
+	FVector RotationAxis;
+	float RotationAngle = 0.f;
+	if constexpr (Kernel == ERotateKernel::TrackBall)
 	{
-		RotationAngle = RotationAngle * -1.f;
+		GetTrackballAngleAndAxis(InInput.CursorPosition, RotationAxis, RotationAngle);
 	}
-	if (FVector::CrossProduct(currentRotVector, LastUpdateMouseRotVector).Z < 0.f)
+	else
 	{
-		RotationAngle = -RotationAngle;
-	}
+		FVector currentRotVector = (CursorIntersection - GroupTransform->GetOriginLocation()).GetSafeNormal();
 
-	// Set the rotation axis. Its determined by the active axis lock. 
-	// Some extra inverting of the axis needs to be done depending on camera position for the mouse interaction to work as a "human" would expect it to.
-	FVector RotationAxis;
-	RotationAxis = AxisLockHelper.LockVector * (FVector::DotProduct(AxisLockHelper.LockVector, GetCameraForwardVector()) < 0 ? -1.f : 1.f);
-	if (AxisLockHelper.CurrentLockedAxis == None)
-	{
-		RotationAxis = ToolViewportClient->GetViewRotation().Vector();
-	}
+		// Gives us the degrees between the cursor starting position and end position in -180 - 180;
+		RotationAngle = UKismetMathLibrary::DegAcos(FVector::DotProduct(currentRotVector, LastUpdateMouseRotVector));
 
-	// Trackball rotation
-	if (IsTrackBallRotating)
-	{
-		GetTrackballAngleAndAxis(RotationAxis, RotationAngle);
+		// First check if the camera is looking down or up and flips. Otherwise dragging the mouse left would rotate the object
+		// to the right whenever we are looking from below. (Hard to explain, just uncomment the first "if" statement to see the behavior.
+		if (ToolViewportClient->GetViewRotation().Vector().Z > 0)
+		{
+			RotationAngle = RotationAngle * -1.f;
+		}
+		if (FVector::CrossProduct(currentRotVector, LastUpdateMouseRotVector).Z < 0.f)
+		{
+			RotationAngle = -RotationAngle;
+		}
+
+		// Set the rotation axis. Its determined by the active axis lock. 
+		// Some extra inverting of the axis needs to be done depending on camera position for the mouse interaction to work as a "human" would expect it to.
+		if constexpr (Kernel == ERotateKernel::Axis)
+		{
+			RotationAxis = AxisLockHelper.LockVector * (FVector::DotProduct(AxisLockHelper.LockVector, GetCameraForwardVector()) < 0 ? -1.f : 1.f);
+		}
+		else
+		{
+			RotationAxis = ToolViewportClient->GetViewRotation().Vector();
+		}
 	}
 
 	// If the mouse did not move between frames we make sure that the output rotation is definitely 0
-	if (LastCursorLocation == GetCursorPosition())
+	if (LastCursorLocation == InInput.CursorPosition)
 	{
 		RotationAngle = 0.f;
 	}
 
 	// Stepping the rotation by AngleStepSnap when Ctrl is pressed
-	if (!IsTrackBallRotating && !ToolViewportClient->IsShiftPressed() && ToolViewportClient->IsCtrlPressed())
+	if (Kernel != ERotateKernel::TrackBall && !InInput.bShiftDown && InInput.bCtrlDown)
 	{
 		CurrentAngleIncrement += FMath::Abs(RotationAngle);
 		float angleDirection = RotationAngle > 0 ? 1.f : -1.f;
@@ -370,18 +1214,18 @@ void FRotateMode::ToolUpdate()
 	}
 
 	// Precision Mode
-	float PrecisionModeScalar = IsPrecisionModeActive() ? 0.1f : 1.0f;
+	float PrecisionModeScalar = InInput.bShiftDown ? 0.1f : 1.0f;
 	RotationAngle *= PrecisionModeScalar;
 
 	FRotator AddRotation = UKismetMathLibrary::RotatorFromAxisAndAngle(RotationAxis, RotationAngle);
 	GroupTransform->AddRotation(AddRotation);
 	
 
+	CursorRotation = GroupTransform->GetAccumulatedRotation();
+
 	LastUpdateMouseRotVector = (CursorIntersection - GroupTransform->GetOriginLocation()).GetSafeNormal();
-	LastCursorLocation = GetCursorPosition();
+	LastCursorLocation = InInput.CursorPosition;
 	LastFrameAngle = RotationAngle;
-
-	DrawAxisLocks();
 }
 
 void FRotateMode::ToolClose(bool Success)
@@ -391,28 +1235,92 @@ void FRotateMode::ToolClose(bool Success)
 	UE_LOG(LogRotateTool, Verbose, TEXT("Closed"));
 }
 
-void FRotateMode::DrawHUD(FEditorViewportClient* ViewportClient, FViewport* Viewport, const FSceneView* View, FCanvas* Canvas)
+void FRotateMode::BuildOverlayState(FToolOverlayState& OutState) const
 {
-	FVector2D MousePosition = GetCursorPosition();
-	const FVector LineStart = FVector(MousePosition.X, MousePosition.Y, 0.f);
-	const FVector LineEnd = FVector(GroupTransform->GetOriginScreenLocation());
-	
-	// Draw a dashed line between the origin and the cursor
-	ToolHelperFunctions::DrawDashedLine(Canvas, LineStart, LineEnd);
+	FBlenderToolMode::BuildOverlayState(OutState);
+
+	// Dashed line between the origin and the cursor
+	OutState.bDrawDashedLine = true;
 }
 
-void FRotateMode::SetAxisLock(const EToolAxisLock& InAxisToLock, bool bDualAxis)
+FString FRotateMode::GetReadout() const
 {
-	FBlenderToolMode::SetAxisLock(InAxisToLock, bDualAxis);
+	if (IsNumericInputActive())
+	{
+		return FBlenderToolMode::GetReadout();
+	}
+
+	return FString::Printf(TEXT("%.1f\u00B0"), FMath::RadiansToDegrees(GroupTransform->GetAccumulatedRotation().GetAngle()));
+}
 
+void FRotateMode::SetAxisLock(const EToolAxisLock& InAxisToLock, bool bDualAxis)
+{
 	// The rotate tool doesn't support two axis rotation because it doesn't make sense
-	AxisLockHelper.IsDualAxisLock = false;
+	FBlenderToolMode::SetAxisLock(InAxisToLock, false);
+
+	SelectKernel();
+}
+
+void FRotateMode::ApplyNumericInput(float InValue)
+{
+	// Without an axis lock the typed angle goes around the view axis, the same axis the free rotation uses
+	const FVector RotationAxis = ActiveKernel == ERotateKernel::Axis ? AxisLockHelper.LockVector : GetCameraForwardVector();
+	GroupTransform->SetRotation(FQuat(RotationAxis, FMath::DegreesToRadians(InValue)));
+}
+
+void FRotateMode::ResumeCursorInput()
+{
+	GroupTransform->SetRotation(CursorRotation);
+
+	ReanchorCursor();
+}
+
+void FRotateMode::ReanchorCursor()
+{
+	const FVector CursorIntersection = GetIntersection();
+	LastUpdateMouseRotVector = (CursorIntersection - GroupTransform->GetOriginLocation()).GetSafeNormal();
+	LastFrameCursorIntersection = CursorIntersection;
+	LastCursorLocation = GetCursorPosition();
+}
+
+void FRotateMode::ToggleTrackBallRotation()
+{
+	IsTrackBallRotating = !IsTrackBallRotating;
+
+	SelectKernel();
+}
+
+void FRotateMode::SelectKernel()
+{
+	// Trackball rotation ignores any axis lock
+	if (IsTrackBallRotating)
+	{
+		ActiveKernel = ERotateKernel::TrackBall;
+		ActiveUpdate = &FRotateMode::UpdateKernel<ERotateKernel::TrackBall>;
+	}
+	else if (AxisLockHelper.IsLocked())
+	{
+		ActiveKernel = ERotateKernel::Axis;
+		ActiveUpdate = &FRotateMode::UpdateKernel<ERotateKernel::Axis>;
+	}
+	else
+	{
+		ActiveKernel = ERotateKernel::Free;
+		ActiveUpdate = &FRotateMode::UpdateKernel<ERotateKernel::Free>;
+	}
 }
 
 FVector FRotateMode::GetIntersection()
 {
+	return GetIntersection(GetCursorPosition());
+}
+
+FVector FRotateMode::GetIntersection(const FIntPoint& InCursorPosition) const
+{
+	FToolPerfScope PerfScope(EToolPerfCategory::Intersection);
+
 	// Project the cursor from the screen to the world
-	TTuple<FVector, FVector> WorldLocDir = ToolHelperFunctions::GetCursorWorldPosition(ToolViewportClient);
+	TTuple<FVector, FVector> WorldLocDir = ToolHelperFunctions::ProjectScreenPositionToWorld(ToolViewportClient, InCursorPosition);
 	FVector CursorWorldPosition = WorldLocDir.Get<0>();
 	FVector CursorWorldDirection = WorldLocDir.Get<1>();
 
@@ -427,9 +1335,9 @@ FVector FRotateMode::GetIntersection()
 	return Intersection;
 }
 
-void FRotateMode::GetTrackballAngleAndAxis(FVector& OutAxis, float& OutAngle)
+void FRotateMode::GetTrackballAngleAndAxis(const FIntPoint& InCursorPosition, FVector& OutAxis, float& OutAngle)
 {
-	TTuple<FVector, FVector> WorldLocDir = ToolHelperFunctions::GetCursorWorldPosition(ToolViewportClient);
+	TTuple<FVector, FVector> WorldLocDir = ToolHelperFunctions::ProjectScreenPositionToWorld(ToolViewportClient, InCursorPosition);
 	FVector CursorWorldPosition = WorldLocDir.Get<0>();
 	FVector CursorWorldDirection = WorldLocDir.Get<1>();
 
@@ -467,13 +1375,47 @@ void FScaleMode::ToolBegin()
 
 void FScaleMode::ToolUpdate()
 {
-	CalculateAxisLock();
-
 	float CurrentDistance = FVector2D::Distance((FVector2D)ActorScreenPosition, (FVector2D)GetCursorPosition());
-	float NewScaleMultiplier = CurrentDistance / StartDistance;
+	float CursorScale = CurrentDistance / StartDistance;
+
+	// Precision Mode
+	float PrecisionModeScalar = IsPrecisionModeActive() ? 0.1f : 1.0f;
+	AccumulatedScale += (CursorScale - LastFrameCursorScale) * PrecisionModeScalar;
+	LastFrameCursorScale = CursorScale;
+
+	// Increment snapping works on the accumulated scale so it composes with precision mode
+	float NewScaleMultiplier = AccumulatedScale;
+	if (IsIncrementSnapping())
+	{
+		NewScaleMultiplier = ToolSnapping::SnapScale(AccumulatedScale, GroupTransform->GetReferenceScale(), GEditor->GetScaleGridSize(), ToolSnapping::GetSnapMode());
+	}
+
+	GroupTransform->SetScale(FVector(NewScaleMultiplier), GetScaleAxis(), ActiveKernel);
+}
+
+void FScaleMode::ApplyNumericInput(float InValue)
+{
+	// A zero scale would collapse the selection, most likely the value is still being typed (e.g. 0.5)
+	if (FMath::IsNearlyZero(InValue))
+	{
+		return;
+	}
+
+	GroupTransform->SetScale(FVector(InValue), GetScaleAxis(), ActiveKernel);
+}
+
+void FScaleMode::ReanchorCursor()
+{
+	// The scale continues from the accumulated scale, the cursor distance it is measured against starts over
+	ActorScreenPosition = ToolHelperFunctions::ProjectWorldLocationToScreen(ToolViewportClient, GroupTransform->GetOriginLocation());
+	StartDistance = FMath::Max(FVector2D::Distance((FVector2D)ActorScreenPosition, (FVector2D)GetCursorPosition()), 1.f);
+	LastFrameCursorScale = 1.f;
+}
 
-	GroupTransform->SetScale(FVector(NewScaleMultiplier), AxisLockHelper.LockVector, !AxisLockHelper.IsLocked());
-	DrawAxisLocks();
+FVector FScaleMode::GetScaleAxis() const
+{
+	// Plane scaling scales everything except the axis the plane normal points along
+	return ActiveKernel == EScaleKernel::Plane ? AxisLockHelper.LockPlaneNormal : AxisLockHelper.LockVector;
 }
 
 void FScaleMode::ToolClose(bool Success)
@@ -482,134 +1424,762 @@ void FScaleMode::ToolClose(bool Success)
 	UE_LOG(LogScaleTool, Verbose, TEXT("Closed"));
 }
 
-void FScaleMode::DrawHUD(FEditorViewportClient* ViewportClient, FViewport* Viewport, const FSceneView* View, FCanvas* Canvas)
+void FScaleMode::BuildOverlayState(FToolOverlayState& OutState) const
 {
-	FVector2D MousePosition = GetCursorPosition();
-	const FVector LineStart = FVector(MousePosition.X, MousePosition.Y, 0.f);
-	const FVector LineEnd = FVector(GroupTransform->GetOriginScreenLocation());
+	FBlenderToolMode::BuildOverlayState(OutState);
 
-	// Draw a dashed line between the origin and the cursor
-	ToolHelperFunctions::DrawDashedLine(Canvas, LineStart, LineEnd);
+	// Dashed line between the origin and the cursor
+	OutState.bDrawDashedLine = true;
 }
 
-void FGroupTransform::SetScale(const FVector& InNewScale, const FVector& ScaleAxis, const bool bUniformScale)
+FString FScaleMode::GetReadout() const
 {
-	for (const FChildTransform& Child : Children)
+	if (IsNumericInputActive())
 	{
-		FVector BiasScale;
-		if (!bUniformScale)
-		{
-			FVector newScaleAxis = ScaleAxis;
+		return FBlenderToolMode::GetReadout();
+	}
 
-			float X_Alpha = FMath::Abs(FVector::DotProduct(newScaleAxis, Child.Actor->GetActorForwardVector()));
-			float Y_Alpha = FMath::Abs(FVector::DotProduct(newScaleAxis, Child.Actor->GetActorRightVector()));
-			float Z_Alpha = FMath::Abs(FVector::DotProduct(newScaleAxis, Child.Actor->GetActorUpVector()));
+	return FString::Printf(TEXT("x%.3f"), AccumulatedScale);
+}
 
-			float x, y, z;
-			x = FMath::Lerp(1.f, InNewScale.X, X_Alpha);
-			y = FMath::Lerp(1.f, InNewScale.Y, Y_Alpha);
-			z = FMath::Lerp(1.f, InNewScale.Z, Z_Alpha);
+void FScaleMode::SetAxisLock(const EToolAxisLock& InAxisToLock, bool bDualAxis)
+{
+	FBlenderToolMode::SetAxisLock(InAxisToLock, bDualAxis);
 
-			BiasScale = FVector(x, y, z);
-		}
-		else
+	if (!AxisLockHelper.IsLocked())
+	{
+		ActiveKernel = EScaleKernel::Uniform;
+	}
+	else
+	{
+		ActiveKernel = AxisLockHelper.IsDualAxisLock ? EScaleKernel::Plane : EScaleKernel::Axis;
+	}
+}
+
+void FGroupTransform::SetScale(const FVector& InNewScale, const FVector& ScaleAxis, const EScaleKernel InKernel)
+{
+	switch (InKernel)
+	{
+	case EScaleKernel::Uniform:
+		SetScaleKernel<EScaleKernel::Uniform>(InNewScale, ScaleAxis);
+		break;
+	case EScaleKernel::Axis:
+		SetScaleKernel<EScaleKernel::Axis>(InNewScale, ScaleAxis);
+		break;
+	case EScaleKernel::Plane:
+		SetScaleKernel<EScaleKernel::Plane>(InNewScale, ScaleAxis);
+		break;
+	}
+}
+
+template<EScaleKernel Kernel>
+void FGroupTransform::SetScaleKernel(const FVector& InNewScale, const FVector& ScaleAxis)
+{
+	const FVector PivotLocation = ParentOriginalTransform.GetLocation();
+	const int32 NumChildren = ChildRecords.Num();
+
+	CurrentScale = InNewScale;
+	CurrentScaleAxis = ScaleAxis;
+	CurrentScaleKernel = Kernel;
+
+	// The axis kernels blend the scale into the local axes of each child by how much each axis is aligned with the locked axis
+	// (or how much it lies in the locked plane). The local axes are only captured the first time an axis kernel runs.
+	if constexpr (Kernel != EScaleKernel::Uniform)
+	{
+		if (ChildBasis.Num() != NumChildren)
+		{
+			ChildBasis.SetNum(NumChildren);
+			for (int32 ChildIndex = 0; ChildIndex < NumChildren; ++ChildIndex)
+			{
+				ChildBasis.Set(ChildIndex, ChildRecords[ChildIndex].Rotation.Unpack());
+			}
+		}
+
+		ToolKernels::BiasScaleBatch(ChildBasis, FVector3f(ScaleAxis), FVector3f(InNewScale), Kernel == EScaleKernel::Plane, ChildBiasScale);
+	}
+
+	const FVector3f UniformScale(InNewScale);
+	ChildTargetScales.SetNum(NumChildren);
+	ParallelFor(NumChildren, [this, &UniformScale](int32 ChildIndex)
+	{
+		FVector3f BiasScale = UniformScale;
+		if constexpr (Kernel != EScaleKernel::Uniform)
 		{
-			BiasScale = InNewScale;
+			BiasScale = ChildBiasScale.Get(ChildIndex);
 		}
 
-		FTransform ScaleTransform = FTransform(FQuat::Identity, FVector::ZeroVector, BiasScale);
-		FTransform ScaleAroundParent = FTransform(-Parent.GetLocation()) * ScaleTransform * FTransform(Parent.GetLocation());
+		ChildTargetScales.Set(ChildIndex, ChildRecords[ChildIndex].Scale * BiasScale);
+	}, NumChildren < ParallelPrepareMinChildren);
 
-		FTransform NewChildTransform = Child.ChildOriginalTransform * ScaleAroundParent;
+	// With individual origins every child is scaled in place, only scaling around the pivot moves the children
+	if (PivotMode == EToolPivotMode::IndividualOrigins)
+	{
+		WriteBack(ETransformComponents::Scale);
+		return;
+	}
 
-		Child.Actor->Modify();
-		Child.Actor->SetActorTransform(NewChildTransform);
+	if constexpr (Kernel != EScaleKernel::Uniform)
+	{
+		ToolKernels::ScaleOffsetsBatch(ChildRecords, ChildBiasScale, ChildTargetOffsets);
 	}
+	else
+	{
+		ToolKernels::ScaleOffsetsBatch(ChildRecords, FVector3f(InNewScale), ChildTargetOffsets);
+	}
+
+	TargetPivot = PivotLocation;
+	bTargetOffsetsFromRecords = false;
+	WriteBack(ETransformComponents::Location | ETransformComponents::Scale);
 }
 
 void FGroupTransform::SetAverageLocation()
 {
+	if (PendingChildTransforms.Num() == 0)
+	{
+		return;
+	}
+
 	FVector averageLocation = FVector::ZeroVector;
-	for (auto& Child : Children)
+	for (const FTransform& ChildTransform : PendingChildTransforms)
 	{
-		averageLocation += Child.Actor->GetActorLocation();
+		averageLocation += ChildTransform.GetLocation();
 	}
-	averageLocation /= Children.Num();
+	averageLocation /= PendingChildTransforms.Num();
 	Parent.SetLocation(averageLocation);
 }
 
 void FGroupTransform::AddRotation(const FRotator& InAddRotation)
 {
-	FTransform RotationAroundParent = FTransform(-Parent.GetLocation()) * FTransform(InAddRotation.Quaternion()) * FTransform(Parent.GetLocation());
-	for (auto& Child : Children)
+	SetRotation(InAddRotation.Quaternion() * AccumulatedRotation);
+}
+
+void FGroupTransform::SetRotation(const FQuat& InRotation)
+{
+	// Rotating from the original transforms by the accumulated rotation means we never have to read back the current actor transforms
+	AccumulatedRotation = InRotation;
+	AccumulatedRotation.Normalize();
+
+	const FQuat4f Rotation(AccumulatedRotation);
+	const FVector PivotLocation = ParentOriginalTransform.GetLocation();
+
+	if (PivotMode == EToolPivotMode::IndividualOrigins)
 	{
-		FTransform RotatedTransform = Child.Actor->GetTransform() * RotationAroundParent;
+		// The same world space rotation as around the median point, but the children stay where they are. 
+		// The result doesn't depend on which child comes first
+		ToolKernels::MultiplyRotationsBatch(Rotation, ChildRecords, FQuat4f::Identity, ChildTargetRotations);
 
-		Child.Actor->Modify();
-		Child.Actor->SetActorTransform(RotatedTransform);
+		WriteBack(ETransformComponents::Rotation);
+		return;
 	}
+
+	// Rotating around the pivot rotates the offsets to the pivot and the children themselves
+	ToolKernels::RotateOffsetsBatch(ChildRecords, Rotation, ChildTargetOffsets);
+	ToolKernels::MultiplyRotationsBatch(Rotation, ChildRecords, FQuat4f::Identity, ChildTargetRotations);
+
+	TargetPivot = PivotLocation;
+	bTargetOffsetsFromRecords = false;
+	WriteBack(ETransformComponents::Location | ETransformComponents::Rotation);
 }
 
 void FGroupTransform::SetLocation(const FVector& InNewLocation)
 {
 	Parent.SetLocation(InNewLocation);
 
-	for (auto& Child : Children)
+	// Moving doesn't change the offsets to the pivot
+	TargetPivot = Parent.GetLocation();
+	bTargetOffsetsFromRecords = true;
+	WriteBack(ETransformComponents::Location);
+}
+
+void FGroupTransform::AddLocation(const FVector& InOffset)
+{
+	SetLocation(Parent.GetLocation() + InOffset);
+}
+
+void FGroupTransform::ResetTransforms(ETransformComponents InComponents)
+{
+	// Only the reset parts are written, so they can be filled with constants without knowing the original transforms
+	const int32 NumChildren = ChildActors.Num();
+	const bool bResetLocation = EnumHasAnyFlags(InComponents, ETransformComponents::Location);
+	const bool bResetRotation = EnumHasAnyFlags(InComponents, ETransformComponents::Rotation);
+	const bool bResetScale = EnumHasAnyFlags(InComponents, ETransformComponents::Scale);
+	if (bResetLocation)
+	{
+		TargetPivot = FVector::ZeroVector;
+		bTargetOffsetsFromRecords = false;
+		ChildTargetOffsets.SetNum(NumChildren);
+	}
+	if (bResetRotation)
 	{
-		FVector RelativeLocation = -Child.RelativeOffset + Parent.GetLocation();
+		ChildTargetRotations.SetNum(NumChildren, false);
+	}
+	if (bResetScale)
+	{
+		ChildTargetScales.SetNum(NumChildren);
+	}
+
+	ParallelFor(NumChildren, [this, bResetLocation, bResetRotation, bResetScale](int32 ChildIndex)
+	{
+		if (bResetLocation)
+		{
+			ChildTargetOffsets.Set(ChildIndex, FVector3f::ZeroVector);
+		}
+		if (bResetRotation)
+		{
+			ChildTargetRotations[ChildIndex] = FQuat4f::Identity;
+		}
+		if (bResetScale)
+		{
+			ChildTargetScales.Set(ChildIndex, FVector3f::OneVector);
+		}
+	}, NumChildren < ParallelPrepareMinChildren);
+
+	WriteBack(InComponents);
+}
+
+void FGroupTransform::Randomize(const FVector& InLocationRange, const FRotator& InRotationRange, const FVector& InScaleRange, bool bUniformScale, int32 InSeed)
+{
+	const int32 NumChildren = ChildRecords.Num();
+	ChildTargetOffsets.SetNum(NumChildren);
+	ChildTargetRotations.SetNum(NumChildren, false);
+	ChildTargetScales.SetNum(NumChildren);
+	ParallelFor(NumChildren, [this, &InLocationRange, &InRotationRange, &InScaleRange, bUniformScale, InSeed](int32 ChildIndex)
+	{
+		const uint64 Stream = ToolKernels::RandomStream(ChildActors[ChildIndex]->GetActorGuid(), InSeed);
+
+		// Every component has its own counter, so changing one range leaves the others as they were
+		const FVector LocationOffset(
+			ToolKernels::SignedRandom(Stream, 0) * InLocationRange.X,
+			ToolKernels::SignedRandom(Stream, 1) * InLocationRange.Y,
+			ToolKernels::SignedRandom(Stream, 2) * InLocationRange.Z);
+
+		const FRotator RotationOffset(
+			ToolKernels::SignedRandom(Stream, 3) * InRotationRange.Pitch,
+			ToolKernels::SignedRandom(Stream, 4) * InRotationRange.Yaw,
+			ToolKernels::SignedRandom(Stream, 5) * InRotationRange.Roll);
 
-		Child.Actor->Modify();
-		Child.Actor->SetActorLocation(RelativeLocation);
+		FVector ScaleFactor = FVector::OneVector;
+		if (bUniformScale)
+		{
+			ScaleFactor += FVector(ToolKernels::SignedRandom(Stream, 6) * InScaleRange.X);
+		}
+		else
+		{
+			ScaleFactor += FVector(
+				ToolKernels::SignedRandom(Stream, 6) * InScaleRange.X,
+				ToolKernels::SignedRandom(Stream, 7) * InScaleRange.Y,
+				ToolKernels::SignedRandom(Stream, 8) * InScaleRange.Z);
+		}
+
+		const FChildRecord& Record = ChildRecords[ChildIndex];
+		ChildTargetOffsets.Set(ChildIndex, Record.Offset + FVector3f(LocationOffset));
+		ChildTargetRotations[ChildIndex] = Record.Rotation.Unpack() * FQuat4f(RotationOffset.Quaternion());
+		ChildTargetScales.Set(ChildIndex, Record.Scale * FVector3f(ScaleFactor.ComponentMax(FVector(KINDA_SMALL_NUMBER))));
+	}, NumChildren < ParallelPrepareMinChildren);
+
+	TargetPivot = ParentOriginalTransform.GetLocation();
+	bTargetOffsetsFromRecords = false;
+	WriteBack(ETransformComponents::All);
+}
+
+void FGroupTransform::SetTransforms(const TArray<FTransform>& InTransforms, ETransformComponents InComponents)
+{
+	check(InTransforms.Num() == ChildActors.Num());
+
+	// Proportionally edited actors follow the average displacement of the children from their records
+	if (ProportionalActors.Num() > 0 && ChildRecords.Num() == InTransforms.Num() && EnumHasAnyFlags(InComponents, ETransformComponents::Location))
+	{
+		const FVector OriginalPivot = ParentOriginalTransform.GetLocation();
+		FVector Displacement = FVector::ZeroVector;
+		for (int32 ChildIndex = 0; ChildIndex < InTransforms.Num(); ++ChildIndex)
+		{
+			Displacement += InTransforms[ChildIndex].GetLocation() - (OriginalPivot + FVector(ChildRecords[ChildIndex].Offset));
+		}
+
+		Parent.SetLocation(OriginalPivot + Displacement / InTransforms.Num());
 	}
+
+	WriteBack(InComponents, &InTransforms);
 }
 
-void FGroupTransform::AddLocation(const FVector& InOffset)
+/** 
+* Records the transform of InActor in the transaction. The transform lives in the root component, so recording only the root component keeps the undo record small.
+* Returns false when nothing was recorded, because there is no transaction or the object is not transactional.
+*/
+static bool ModifyTransform(AActor* InActor)
+{
+	if (USceneComponent* RootComponent = InActor->GetRootComponent())
+	{
+		return RootComponent->Modify();
+	}
+
+	return InActor->Modify();
+}
+
+void FGroupTransform::RecordActor(AActor* InActor)
+{
+	if (!ModifyTransform(InActor))
+	{
+		// Nothing has been written to the actor yet, so this is its original transform
+		UnrecordedActors.Add(InActor);
+		UnrecordedTransforms.Add(InActor->GetActorTransform());
+	}
+}
+
+void FGroupTransform::RestoreUnrecordedActors()
+{
+	for (int32 ActorIndex = 0; ActorIndex < UnrecordedActors.Num(); ++ActorIndex)
+	{
+		UnrecordedActors[ActorIndex]->SetActorTransform(UnrecordedTransforms[ActorIndex], false, nullptr, ETeleportType::TeleportPhysics);
+	}
+
+	if (UnrecordedActors.Num() > 0)
+	{
+		UE_LOG(LogBlenderTool, Log, TEXT("Restored %d actors the transaction did not record"), UnrecordedActors.Num());
+	}
+}
+
+void FGroupTransform::WriteBack(ETransformComponents InComponents, const TArray<FTransform>* InTransforms)
+{
+	FToolPerfScope PerfScope(EToolPerfCategory::WriteBack);
+
+	// Recording the actors again every frame would only cost transaction lookups, so it only happens on the first write
+	if (!bChildrenModified)
+	{
+		for (AActor* ChildActor : ChildActors)
+		{
+			RecordActor(ChildActor);
+		}
+
+		bChildrenModified = true;
+	}
+
+	if (InTransforms)
+	{
+		WriteTransforms(ChildActors, *InTransforms, InComponents);
+	}
+	else
+	{
+		WriteTargets(InComponents);
+	}
+
+	WriteProportionalActors(InComponents);
+
+	SET_MEMORY_STAT(STAT_BlenderViewportControls_GroupMemory, GetAllocatedSize());
+}
+
+void FGroupTransform::WriteProportionalActors(ETransformComponents InComponents)
+{
+	// Proportionally edited actors are picked up while the operation runs, so they are recorded as they join
+	for (AActor* ProportionalActor : ProportionalActors)
+	{
+		bool bAlreadyModified = false;
+		ModifiedProportionalActors.Add(ProportionalActor, &bAlreadyModified);
+		if (!bAlreadyModified)
+		{
+			RecordActor(ProportionalActor);
+		}
+	}
+
+	if (ProportionalActors.Num() > 0)
+	{
+		PrepareProportionalTargets();
+		WriteTransforms(ProportionalActors, ProportionalTargetTransforms, InComponents);
+	}
+}
+
+void FGroupTransform::WriteTargets(ETransformComponents InComponents)
+{
+	// Same setters as WriteTransforms, but the transforms are put together from the kernel outputs as they are written
+	const ETeleportType TeleportType = ETeleportType::TeleportPhysics;
+	const int32 NumChildren = ChildActors.Num();
+	switch (InComponents)
+	{
+	case ETransformComponents::None:
+		break;
+	case ETransformComponents::Location:
+		for (int32 ChildIndex = 0; ChildIndex < NumChildren; ++ChildIndex)
+		{
+			ChildActors[ChildIndex]->SetActorLocation(GetTargetLocation(ChildIndex), false, nullptr, TeleportType);
+		}
+		break;
+	case ETransformComponents::Rotation:
+		for (int32 ChildIndex = 0; ChildIndex < NumChildren; ++ChildIndex)
+		{
+			ChildActors[ChildIndex]->SetActorRotation(FQuat(ChildTargetRotations[ChildIndex]), TeleportType);
+		}
+		break;
+	case ETransformComponents::Scale:
+		for (int32 ChildIndex = 0; ChildIndex < NumChildren; ++ChildIndex)
+		{
+			ChildActors[ChildIndex]->SetActorScale3D(FVector(ChildTargetScales.Get(ChildIndex)));
+		}
+		break;
+	case ETransformComponents::Location | ETransformComponents::Rotation:
+		for (int32 ChildIndex = 0; ChildIndex < NumChildren; ++ChildIndex)
+		{
+			ChildActors[ChildIndex]->SetActorLocationAndRotation(GetTargetLocation(ChildIndex), FQuat(ChildTargetRotations[ChildIndex]), false, nullptr, TeleportType);
+		}
+		break;
+	default:
+		// Parts that are not written keep the current transform of the actor
+		for (int32 ChildIndex = 0; ChildIndex < NumChildren; ++ChildIndex)
+		{
+			FTransform Transform = ChildActors[ChildIndex]->GetActorTransform();
+			if (EnumHasAnyFlags(InComponents, ETransformComponents::Location))
+			{
+				Transform.SetLocation(GetTargetLocation(ChildIndex));
+			}
+			if (EnumHasAnyFlags(InComponents, ETransformComponents::Rotation))
+			{
+				Transform.SetRotation(FQuat(ChildTargetRotations[ChildIndex]));
+			}
+			if (EnumHasAnyFlags(InComponents, ETransformComponents::Scale))
+			{
+				Transform.SetScale3D(FVector(ChildTargetScales.Get(ChildIndex)));
+			}
+
+			ChildActors[ChildIndex]->SetActorTransform(Transform, false, nullptr, TeleportType);
+		}
+		break;
+	}
+}
+
+void FGroupTransform::WriteTransforms(const TArray<AActor*>& InActors, const TArray<FTransform>& InTransforms, ETransformComponents InComponents)
+{
+	// Teleporting skips the physics velocity update, the render transforms are only sent at the end of the frame anyway
+	const ETeleportType TeleportType = ETeleportType::TeleportPhysics;
+	switch (InComponents)
+	{
+	case ETransformComponents::None:
+		break;
+	case ETransformComponents::Location:
+		for (int32 ChildIndex = 0; ChildIndex < InActors.Num(); ++ChildIndex)
+		{
+			InActors[ChildIndex]->SetActorLocation(InTransforms[ChildIndex].GetLocation(), false, nullptr, TeleportType);
+		}
+		break;
+	case ETransformComponents::Rotation:
+		for (int32 ChildIndex = 0; ChildIndex < InActors.Num(); ++ChildIndex)
+		{
+			InActors[ChildIndex]->SetActorRotation(InTransforms[ChildIndex].GetRotation(), TeleportType);
+		}
+		break;
+	case ETransformComponents::Scale:
+		for (int32 ChildIndex = 0; ChildIndex < InActors.Num(); ++ChildIndex)
+		{
+			InActors[ChildIndex]->SetActorScale3D(InTransforms[ChildIndex].GetScale3D());
+		}
+		break;
+	case ETransformComponents::Location | ETransformComponents::Rotation:
+		for (int32 ChildIndex = 0; ChildIndex < InActors.Num(); ++ChildIndex)
+		{
+			InActors[ChildIndex]->SetActorLocationAndRotation(InTransforms[ChildIndex].GetLocation(), InTransforms[ChildIndex].GetRotation(), false, nullptr, TeleportType);
+		}
+		break;
+	default:
+		for (int32 ChildIndex = 0; ChildIndex < InActors.Num(); ++ChildIndex)
+		{
+			InActors[ChildIndex]->SetActorTransform(InTransforms[ChildIndex], false, nullptr, TeleportType);
+		}
+		break;
+	}
+}
+
+void FGroupTransform::PrepareProportionalTargets()
 {
-	Parent.SetLocation(Parent.GetLocation() + InOffset);
+	// The group delta is applied around the original origin and scaled down by the weight of each actor
+	const FVector Pivot = ParentOriginalTransform.GetLocation();
+	const FVector Offset = Parent.GetLocation() - Pivot;
 
-	for (auto& Child : Children)
+	ProportionalTargetTransforms.SetNum(ProportionalActors.Num(), false);
+	for (int32 ChildIndex = 0; ChildIndex < ProportionalActors.Num(); ++ChildIndex)
 	{
-		FVector RelativeLocation = -Child.RelativeOffset + Parent.GetLocation();
+		const FTransform& Original = ProportionalOriginalTransforms[ChildIndex];
+		const float Weight = ProportionalWeights[ChildIndex];
 
-		Child.Actor->Modify();
-		Child.Actor->SetActorLocation(RelativeLocation);
+		FVector Scale = CurrentScale;
+		if (CurrentScaleKernel != EScaleKernel::Uniform)
+		{
+			Scale = ToolKernels::BiasScale(Original.GetRotation(), CurrentScaleAxis, CurrentScale, CurrentScaleKernel == EScaleKernel::Plane);
+		}
+
+		const FVector WeightedScale = FMath::Lerp(FVector::OneVector, Scale, (double)Weight);
+		const FQuat WeightedRotation = FQuat::Slerp(FQuat::Identity, AccumulatedRotation, Weight);
+
+		const FTransform ScaleAroundPivot(FQuat::Identity, Pivot - WeightedScale * Pivot, WeightedScale);
+		const FTransform RotationAroundPivot(WeightedRotation, Pivot - WeightedRotation.RotateVector(Pivot));
+
+		ProportionalTargetTransforms[ChildIndex] = Original * ScaleAroundPivot * RotationAroundPivot * FTransform(Offset * Weight);
 	}
 }
 
-void FGroupTransform::AddChild(AActor* NewChild, const FIntPoint& InScreenspaceOffset)
+/** Actors proportional editing may move: what the viewport selection could pick, minus the environment around the edited actors */
+static bool IsProportionalCandidate(AActor* InActor)
 {
-	Children.Add(FChildTransform(NewChild, InScreenspaceOffset));
+	if (!ToolHelperFunctions::IsSelectableInViewport(InActor) || InActor->IsLockLocation() || InActor->GetAttachParentActor())
+	{
+		return false;
+	}
+
+	// Landscapes, volumes, lights and sky or fog actors span or light the scene, dragging them along with nearby actors is never intended
+	return !InActor->IsA<ALandscapeProxy>() && !InActor->IsA<ABrush>() && !InActor->IsA<ALight>() && !InActor->IsA<AInfo>();
+}
+
+void FGroupTransform::SetProportionalRadius(float InRadius)
+{
+	if (!ProportionalGrid.IsBuilt())
+	{
+		// Children and everything attached to them already follow the group
+		TSet<const AActor*> IgnoredActors;
+		for (AActor* ChildActor : ChildActors)
+		{
+			TArray<AActor*> AttachedActors;
+			ChildActor->GetAttachedActors(AttachedActors, true, true);
+
+			IgnoredActors.Add(ChildActor);
+			IgnoredActors.Append(AttachedActors);
+		}
+
+		TArray<FVector> CandidateLocations;
+		for (TActorIterator<AActor> It(CurrentWorld); It; ++It)
+		{
+			AActor* Actor = *It;
+			if (IgnoredActors.Contains(Actor) || !IsProportionalCandidate(Actor))
+			{
+				continue;
+			}
+
+			ProportionalCandidates.Add(Actor);
+			CandidateLocations.Add(Actor->GetActorLocation());
+		}
+
+		// Queries usually span a few cells, the cell size only has to be in the range of the radius
+		ProportionalGrid.Build(MoveTemp(CandidateLocations), FMath::Max(InRadius, 100.f));
+	}
+
+	// Distance of every candidate in range to its closest child
+	TMap<int32, float> ClosestDistances;
+	TArray<int32> CandidateIndices;
+	const FVector OriginalPivot = ParentOriginalTransform.GetLocation();
+	for (const FChildRecord& Record : ChildRecords)
+	{
+		const FVector ChildLocation = OriginalPivot + FVector(Record.Offset);
+
+		CandidateIndices.Reset();
+		ProportionalGrid.QuerySphere(ChildLocation, InRadius, CandidateIndices);
+		for (int32 CandidateIndex : CandidateIndices)
+		{
+			const float Distance = FVector::Distance(ProportionalGrid.GetPoint(CandidateIndex), ChildLocation);
+			float& ClosestDistance = ClosestDistances.FindOrAdd(CandidateIndex, InRadius);
+			ClosestDistance = FMath::Min(ClosestDistance, Distance);
+		}
+	}
+
+	// Actors that are no longer in range have to go back to where they were, the others are reweighted from their original transform
+	RestoreProportionalChildren();
+	ProportionalActors.Reset();
+	ProportionalOriginalTransforms.Reset();
+	ProportionalWeights.Reset();
+
+	for (const TPair<int32, float>& Pair : ClosestDistances)
+	{
+		// Smoothstep falloff, full weight at the children and zero at the radius
+		const float Falloff = 1.f - Pair.Value / InRadius;
+		const float Weight = Falloff * Falloff * (3.f - 2.f * Falloff);
+		if (Weight > UE_KINDA_SMALL_NUMBER)
+		{
+			AActor* ProportionalActor = ProportionalCandidates[Pair.Key];
+			ProportionalActors.Add(ProportionalActor);
+			ProportionalOriginalTransforms.Add(ProportionalActor->GetTransform());
+			ProportionalWeights.Add(Weight);
+		}
+	}
+
+	// Once the group was written the new weights have to be applied right away, typed values are not applied again by the next frame
+	if (bChildrenModified)
+	{
+		WriteProportionalActors(ETransformComponents::All);
+	}
+
+	UE_LOG(LogBlenderTool, Verbose, TEXT("Proportional editing: %d actors within %.1f units"), ProportionalActors.Num(), InRadius);
+}
+
+void FGroupTransform::ClearProportionalChildren()
+{
+	RestoreProportionalChildren();
+	ProportionalActors.Reset();
+	ProportionalOriginalTransforms.Reset();
+	ProportionalWeights.Reset();
+}
+
+void FGroupTransform::RestoreProportionalChildren()
+{
+	// Only actors that were written to have been recorded in the transaction
+	for (int32 ChildIndex = 0; ChildIndex < ProportionalActors.Num(); ++ChildIndex)
+	{
+		if (ModifiedProportionalActors.Contains(ProportionalActors[ChildIndex]))
+		{
+			ProportionalActors[ChildIndex]->SetActorTransform(ProportionalOriginalTransforms[ChildIndex], false, nullptr, ETeleportType::TeleportPhysics);
+		}
+	}
+}
+
+SIZE_T FGroupTransform::GetAllocatedSize() const
+{
+	return ChildRecords.GetAllocatedSize() + ChildActors.GetAllocatedSize() + PendingChildTransforms.GetAllocatedSize()
+		+ ChildScreenSpaceOffsets.GetAllocatedSize() + ChildBasis.GetAllocatedSize() + ChildBiasScale.GetAllocatedSize()
+		+ ChildTargetOffsets.GetAllocatedSize() + ChildTargetRotations.GetAllocatedSize() + ChildTargetScales.GetAllocatedSize()
+		+ UnrecordedActors.GetAllocatedSize() + UnrecordedTransforms.GetAllocatedSize();
+}
+
+void FGroupTransform::RemoveChildren(const TArray<int32>& InChildIndices)
+{
+	check(!bChildrenModified);
+
+	// The remaining children are moved down in one pass
+	int32 NextRemoved = 0;
+	int32 NumKept = 0;
+	for (int32 ChildIndex = 0; ChildIndex < ChildActors.Num(); ++ChildIndex)
+	{
+		if (NextRemoved < InChildIndices.Num() && InChildIndices[NextRemoved] == ChildIndex)
+		{
+			++NextRemoved;
+			continue;
+		}
+
+		ChildActors[NumKept] = ChildActors[ChildIndex];
+		ChildRecords[NumKept] = ChildRecords[ChildIndex];
+		ChildScreenSpaceOffsets[NumKept] = ChildScreenSpaceOffsets[ChildIndex];
+		++NumKept;
+	}
+
+	ChildActors.SetNum(NumKept, false);
+	ChildRecords.SetNum(NumKept, false);
+	ChildScreenSpaceOffsets.SetNum(NumKept, false);
+
+	// Rebuilt by the next axis or plane scale
+	ChildBasis.SetNum(0);
+}
+
+void FGroupTransform::AddChild(AActor* NewChild)
+{
+	AddChild(NewChild, NewChild->GetTransform());
+}
+
+void FGroupTransform::AddChild(AActor* NewChild, const FTransform& InTransform)
+{
+	ChildActors.Add(NewChild);
+	PendingChildTransforms.Add(InTransform);
+}
+
+void FGroupTransform::AddResetChildren(const TArray<AActor*>& InActors)
+{
+	ChildActors.Append(InActors);
 }
 
 void FGroupTransform::FinishSetup(FEditorViewportClient* InViewportClient)
+{
+	FinishSetup(InViewportClient->GetWorld(), ToolHelperFunctions::GetViewportProjection(InViewportClient), FToolInputState::Get(InViewportClient).CursorPosition);
+}
+
+void FGroupTransform::FinishSetup(const UWorld* InWorld, const FViewportProjection& InProjection, const FIntPoint& InCursorPosition)
 {
 	SetAverageLocation();
-	Parent.SetRotation(Children[0].ChildOriginalTransform.GetRotation());
+	CaptureChildren(InWorld);
+
+	// The children haven't moved yet, so they are where their records say
+	const FVector OriginalPivot = ParentOriginalTransform.GetLocation();
+	ProjectChildren(InProjection, InCursorPosition, [this, &OriginalPivot](int32 ChildIndex)
+	{
+		return OriginalPivot + FVector(ChildRecords[ChildIndex].Offset);
+	});
+}
+
+void FGroupTransform::SetupEstimate(FEditorViewportClient* InViewportClient, const FVector& InPivot)
+{
+	Parent.SetLocation(InPivot);
+	ParentOriginalTransform = Parent;
+	CurrentWorld = InViewportClient->GetWorld();
+
+	UpdateScreenSpace(InViewportClient, FToolInputState::Get(InViewportClient).CursorPosition);
+}
+
+void FGroupTransform::FinishSetup(const UWorld* InWorld, const FVector& InPivot)
+{
+	Parent.SetLocation(InPivot);
+	CaptureChildren(InWorld);
+}
 
-	for (auto& Child : Children)
+void FGroupTransform::CaptureChildren(const UWorld* InWorld)
+{
+	CurrentWorld = InWorld;
+
+	// Everything passed to the tool can have been deleted or filtered out, the group then only keeps its pivot
+	if (PendingChildTransforms.Num() == 0)
 	{
-		Child.RelativeOffset = Parent.GetLocation() - Child.ChildOriginalTransform.GetLocation();
+		ChildRecords.Reset();
+		ChildBasis.SetNum(0);
+		ParentOriginalTransform = Parent;
+		return;
 	}
 
-	// Calculate the screen space offset between the transform origin and the cursor
-	FIntPoint CursorPosition = InViewportClient->GetCursorWorldLocationFromMousePos().GetCursorPos();
-	FIntPoint TransformScreenPosition = ToolHelperFunctions::ProjectWorldLocationToScreen(InViewportClient, GetOriginLocation());
+	Parent.SetRotation(PendingChildTransforms[0].GetRotation());
+
+	ChildRecords.SetNumUninitialized(PendingChildTransforms.Num());
+	for (int32 ChildIndex = 0; ChildIndex < PendingChildTransforms.Num(); ++ChildIndex)
+	{
+		const FTransform& Original = PendingChildTransforms[ChildIndex];
+
+		// The offset is taken in doubles and only then narrowed, so its precision depends on the size of the group, not on its distance to the origin
+		FChildRecord& Record = ChildRecords[ChildIndex];
+		Record.Offset = FVector3f(Original.GetLocation() - Parent.GetLocation());
+		Record.Rotation = FPackedQuat::Pack(FQuat4f(Original.GetRotation()));
+		Record.Scale = FVector3f(Original.GetScale3D());
+	}
+	PendingChildTransforms.Empty();
+
+	// Built by the first axis or plane scale
+	ChildBasis.SetNum(0);
 
-	ScreenSpaceParentCursorOffset = TransformScreenPosition - CursorPosition;
-	CurrentWorld = InViewportClient->GetWorld();
 	ParentOriginalTransform = Parent;
+}
 
-	// Origin location in screen-space used for line drawing
-	OriginScreenLocation = ToolHelperFunctions::ProjectWorldLocationToScreen(InViewportClient, Parent.GetLocation());
+void FGroupTransform::UpdateScreenSpace(FEditorViewportClient* InViewportClient, const FIntPoint& InCursorPosition)
+{
+	UpdateScreenSpace(ToolHelperFunctions::GetViewportProjection(InViewportClient), InCursorPosition);
 }
 
-TArray<AActor*> FGroupTransform::GetAllChildActors()
+void FGroupTransform::UpdateScreenSpace(const FViewportProjection& InProjection, const FIntPoint& InCursorPosition)
 {
-	TArray<AActor*> OutActors;
-	for (auto& Child : Children)
+	ProjectChildren(InProjection, InCursorPosition, [this](int32 ChildIndex)
 	{
-		OutActors.Add(Child.Actor);
+		return ChildActors[ChildIndex]->GetActorLocation();
+	});
+}
+
+template<typename GetChildLocationType>
+void FGroupTransform::ProjectChildren(const FViewportProjection& InProjection, const FIntPoint& InCursorPosition, GetChildLocationType&& GetChildLocation)
+{
+	ChildScreenSpaceOffsets.SetNum(ChildActors.Num(), false);
+	for (int32 ChildIndex = 0; ChildIndex < ChildActors.Num(); ++ChildIndex)
+	{
+		const FIntPoint ChildScreenLocation = ToolHelperFunctions::ProjectWorldLocationToScreen(InProjection, GetChildLocation(ChildIndex));
+		ChildScreenSpaceOffsets[ChildIndex] = InCursorPosition - ChildScreenLocation;
 	}
 
+	// Calculate the screen space offset between the transform origin and the cursor
+	const FIntPoint TransformScreenPosition = ToolHelperFunctions::ProjectWorldLocationToScreen(InProjection, GetOriginLocation());
+	ScreenSpaceParentCursorOffset = TransformScreenPosition - InCursorPosition;
+
+	// Origin location in screen-space used for line drawing
+	OriginScreenLocation = TransformScreenPosition;
+}
+
+TArray<AActor*> FGroupTransform::GetAllAffectedActors()
+{
+	TArray<AActor*> OutActors = ChildActors;
+	OutActors.Append(ProportionalActors);
+
 	return OutActors;
 }
\ No newline at end of file
@@ -0,0 +1,73 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "BlenderViewportControls_TransformSubsystem.h"
+#include "BlenderViewportControls_Tools.h"
+#include "BlenderViewportControls_HelperFunctions.h"
+#include "Editor.h"
+
+#define LOCTEXT_NAMESPACE "BlenderTransformSubsystem"
+
+void UBlenderTransformSubsystem::TranslateActors(const TArray<AActor*>& Actors, FVector Delta)
+{
+	RunOperation(Actors, GetAverageLocation(Actors), EToolPivotMode::Median, LOCTEXT("TranslateActors", "BlenderTool: Translate"), [&Delta](FGroupTransform& Group)
+	{
+		Group.AddLocation(Delta);
+	});
+}
+
+void UBlenderTransformSubsystem::RotateActors(const TArray<AActor*>& Actors, FRotator Rotation, FVector Pivot, bool bIndividualOrigins)
+{
+	const EToolPivotMode PivotMode = bIndividualOrigins ? EToolPivotMode::IndividualOrigins : EToolPivotMode::Median;
+	RunOperation(Actors, Pivot, PivotMode, LOCTEXT("RotateActors", "BlenderTool: Rotate"), [&Rotation](FGroupTransform& Group)
+	{
+		Group.SetRotation(Rotation.Quaternion());
+	});
+}
+
+void UBlenderTransformSubsystem::ScaleActors(const TArray<AActor*>& Actors, FVector Scale, FVector Pivot, bool bIndividualOrigins)
+{
+	const EToolPivotMode PivotMode = bIndividualOrigins ? EToolPivotMode::IndividualOrigins : EToolPivotMode::Median;
+	RunOperation(Actors, Pivot, PivotMode, LOCTEXT("ScaleActors", "BlenderTool: Scale"), [&Scale](FGroupTransform& Group)
+	{
+		Group.SetScale(Scale, FVector::ZeroVector, EScaleKernel::Uniform);
+	});
+}
+
+FVector UBlenderTransformSubsystem::GetAverageLocation(const TArray<AActor*>& Actors) const
+{
+	TArray<AActor*> ValidActors = Actors;
+	ValidActors.RemoveAll([](const AActor* Actor) { return !IsValid(Actor); });
+
+	return ValidActors.Num() > 0 ? ToolHelperFunctions::GetAverageLocation(ValidActors) : FVector::ZeroVector;
+}
+
+void UBlenderTransformSubsystem::RunOperation(const TArray<AActor*>& Actors, const FVector& InPivot, EToolPivotMode InPivotMode, const FText& InOperationName, TFunctionRef<void(FGroupTransform&)> InOperation)
+{
+	TArray<AActor*> ValidActors = Actors;
+	ValidActors.RemoveAll([](const AActor* Actor) { return !IsValid(Actor); });
+	if (ValidActors.Num() == 0)
+	{
+		return;
+	}
+
+	FToolGroupSource Source;
+	Source.Capture(ValidActors);
+
+	FGroupTransform Group;
+	for (const int32 ActorIndex : Source.GetRootIndices())
+	{
+		Group.AddChild(Source.Actors[ActorIndex], Source.Transforms[ActorIndex]);
+	}
+
+	UWorld* World = ValidActors[0]->GetWorld();
+	Group.SetPivotMode(InPivotMode);
+	Group.FinishSetup(World, InPivot);
+
+	GEditor->BeginTransaction(InOperationName);
+	FToolDragSession Session(World);
+	InOperation(Group);
+	Session.Commit(Group.GetAllChildActors());
+	GEditor->EndTransaction();
+}
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,50 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "BlenderViewportControls_Tools.h"
+#include "Engine/StaticMeshActor.h"
+#include "Engine/World.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FIndividualOriginsAxisScaleTest, "BlenderViewportControls.GroupTransform.IndividualOriginsAxisScale",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FIndividualOriginsAxisScaleTest::RunTest(const FString& Parameters)
+{
+	UWorld* World = UWorld::CreateWorld(EWorldType::EditorPreview, false);
+
+	// Two children rotated 90 degrees apart, world X is the local X of the first and the local Y of the second one
+	AStaticMeshActor* FirstActor = World->SpawnActor<AStaticMeshActor>(FVector(0.f, 0.f, 0.f), FRotator::ZeroRotator);
+	AStaticMeshActor* SecondActor = World->SpawnActor<AStaticMeshActor>(FVector(500.f, 0.f, 0.f), FRotator(0.f, 90.f, 0.f));
+
+	const FVector ExpectedFirstScale(2.f, 1.f, 1.f);
+	const FVector ExpectedSecondScale(1.f, 2.f, 1.f);
+
+	// The scale of every child only depends on its own rotation, not on which child was added first
+	const TArray<AActor*> Orders[] = { { FirstActor, SecondActor }, { SecondActor, FirstActor } };
+	for (const TArray<AActor*>& Order : Orders)
+	{
+		FirstActor->SetActorScale3D(FVector::OneVector);
+		SecondActor->SetActorScale3D(FVector::OneVector);
+
+		FGroupTransform Group;
+		for (AActor* Actor : Order)
+		{
+			Group.AddChild(Actor);
+		}
+		Group.SetPivotMode(EToolPivotMode::IndividualOrigins);
+		Group.FinishSetup(World, FVector::ZeroVector);
+		Group.SetScale(FVector(2.f), FVector::ForwardVector, EScaleKernel::Axis);
+
+		const TCHAR* OrderName = Order[0] == FirstActor ? TEXT("first actor added first") : TEXT("second actor added first");
+		TestTrue(FString::Printf(TEXT("Unrotated child is scaled along its local X (%s)"), OrderName), FirstActor->GetActorScale3D().Equals(ExpectedFirstScale, 1e-3));
+		TestTrue(FString::Printf(TEXT("Rotated child is scaled along its local Y (%s)"), OrderName), SecondActor->GetActorScale3D().Equals(ExpectedSecondScale, 1e-3));
+		TestTrue(FString::Printf(TEXT("Children keep their locations (%s)"), OrderName), SecondActor->GetActorLocation().Equals(FVector(500.f, 0.f, 0.f), 1e-3));
+	}
+
+	World->DestroyWorld(false);
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
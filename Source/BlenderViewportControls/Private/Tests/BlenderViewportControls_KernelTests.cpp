@@ -0,0 +1,136 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "BlenderViewportControls_Kernels.h"
+#include "BlenderViewportControls_HelperFunctions.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FAlignToNormalsBatchTest, "BlenderViewportControls.Kernels.AlignToNormalsBatch",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+// Largest angle a batched alignment may differ from the scalar version, the batch uses float approximations of acos, atan2 and sincos
+static constexpr double AlignmentToleranceDegrees = 0.05;
+
+// Pairs this close to one of the thresholds of the scalar version can take the other branch in float, they are not compared
+static constexpr double AlignmentBranchMargin = 1e-3;
+
+/** True when the scalar version decides a branch on a value within AlignmentBranchMargin of its threshold */
+static bool IsNearAlignmentBranch(const FQuat& InRotation, const FVector& InModelAxis, const FVector& InNormal)
+{
+	const FQuat InverseRotation = InRotation.Inverse();
+	const FVector DestNormalModelSpace = InverseRotation.RotateVector(InNormal);
+	FVector PitchReferenceAxis = InverseRotation.RotateVector(FVector::UpVector);
+
+	const double NormalDot = InNormal | InRotation.RotateVector(InModelAxis);
+	const double PitchReferenceDot = FMath::Abs(InModelAxis | PitchReferenceAxis);
+	if (FMath::Abs(1.0 - FMath::Abs(NormalDot) - KINDA_SMALL_NUMBER) < AlignmentBranchMargin || FMath::Abs(PitchReferenceDot - 0.7) < AlignmentBranchMargin)
+	{
+		return true;
+	}
+
+	// The yaw is only applied when the pitched model axis is still further than the coincident threshold from the normal
+	if (PitchReferenceDot > 0.7)
+	{
+		PitchReferenceAxis = DestNormalModelSpace;
+	}
+	const double Pitch = FMath::Acos(PitchReferenceAxis | DestNormalModelSpace) - FMath::Acos(PitchReferenceAxis | InModelAxis);
+	const FQuat PitchedRotation = InRotation * FQuat(FVector::CrossProduct(PitchReferenceAxis, InModelAxis).GetSafeNormal(), Pitch);
+	return FMath::Abs((InNormal | PitchedRotation.RotateVector(InModelAxis)) - 0.98) < AlignmentBranchMargin;
+}
+
+bool FAlignToNormalsBatchTest::RunTest(const FString& Parameters)
+{
+	const FVector ModelAxis = FVector::UpVector;
+	FRandomStream Random(0x5EED);
+
+	// Not a multiple of the lane width, so the last register has padding lanes
+	const int32 NumPairs = 1027;
+	TestTrue(TEXT("The pair count leaves padding lanes"), NumPairs % ToolKernelLaneWidth != 0);
+
+	TArray<FQuat> Rotations;
+	TArray<FVector> Normals;
+	TArray<bool> AntiParallel;
+	for (int32 Index = 0; Index < NumPairs; ++Index)
+	{
+		const FQuat Rotation = FRotator(Random.FRandRange(-180.f, 180.f), Random.FRandRange(-180.f, 180.f), Random.FRandRange(-180.f, 180.f)).Quaternion();
+		const FVector ModelAxisWorld = Rotation.RotateVector(ModelAxis);
+
+		// Every tenth pair is parallel and every tenth anti-parallel to the model axis, the rest is random
+		FVector Normal;
+		switch (Index % 10)
+		{
+		case 0: Normal = ModelAxisWorld; break;
+		case 1: Normal = -ModelAxisWorld; break;
+		default: Normal = Random.GetUnitVector(); break;
+		}
+
+		Rotations.Add(Rotation);
+		Normals.Add(Normal);
+		AntiParallel.Add(Index % 10 == 1);
+	}
+
+	FQuatSoA RotationsSoA;
+	FVectorSoA NormalsSoA;
+	RotationsSoA.SetNum(NumPairs);
+	NormalsSoA.SetNum(NumPairs);
+	for (int32 Index = 0; Index < NumPairs; ++Index)
+	{
+		RotationsSoA.Set(Index, FQuat4f(Rotations[Index]));
+		NormalsSoA.Set(Index, FVector3f(Normals[Index]));
+	}
+
+	FQuatSoA AlignedRotations;
+	TArray<int32> ScalarIndices;
+	ToolKernels::AlignToNormalsBatch(RotationsSoA, NormalsSoA, FVector3f(ModelAxis), AlignedRotations, ScalarIndices);
+
+	TestEqual(TEXT("One aligned rotation per pair"), AlignedRotations.Num(), NumPairs);
+
+	// Anti-parallel pairs are left to the scalar version, padding lanes are never reported
+	for (const int32 ScalarIndex : ScalarIndices)
+	{
+		if (!TestTrue(TEXT("Scalar fallback index is a real pair"), ScalarIndex >= 0 && ScalarIndex < NumPairs))
+		{
+			return false;
+		}
+		TestTrue(FString::Printf(TEXT("Pair %d left to the scalar version is anti-parallel"), ScalarIndex), AntiParallel[ScalarIndex]);
+	}
+	for (int32 Index = 0; Index < NumPairs; ++Index)
+	{
+		if (AntiParallel[Index])
+		{
+			TestTrue(FString::Printf(TEXT("Anti-parallel pair %d is left to the scalar version"), Index), ScalarIndices.Contains(Index));
+		}
+	}
+
+	const double Tolerance = FMath::DegreesToRadians(AlignmentToleranceDegrees);
+	int32 NumCompared = 0;
+	for (int32 Index = 0; Index < NumPairs; ++Index)
+	{
+		if (AntiParallel[Index] || (Index % 10 != 0 && IsNearAlignmentBranch(Rotations[Index], ModelAxis, Normals[Index])))
+		{
+			continue;
+		}
+
+		const FQuat Expected = ToolHelperFunctions::FindActorAlignmentRotation(Rotations[Index], ModelAxis, Normals[Index]);
+		const double Error = Expected.AngularDistance(FQuat(AlignedRotations.Get(Index)));
+		TestTrue(FString::Printf(TEXT("Pair %d is within %.3f degrees of the scalar version (%.4f)"), Index, AlignmentToleranceDegrees, FMath::RadiansToDegrees(Error)), Error <= Tolerance);
+		++NumCompared;
+	}
+
+	// Guards against the margin skipping most of the random pairs
+	TestTrue(TEXT("Most pairs are compared"), NumCompared > NumPairs * 3 / 4);
+
+	// The helper solves the pairs the batch left out with the scalar version
+	TArray<FQuat> HelperRotations;
+	ToolHelperFunctions::FindActorAlignmentRotations(Rotations, ModelAxis, Normals, HelperRotations);
+	for (const int32 ScalarIndex : ScalarIndices)
+	{
+		const FQuat Expected = ToolHelperFunctions::FindActorAlignmentRotation(Rotations[ScalarIndex], ModelAxis, Normals[ScalarIndex]);
+		TestTrue(FString::Printf(TEXT("Anti-parallel pair %d matches the scalar version"), ScalarIndex), Expected.AngularDistance(HelperRotations[ScalarIndex]) <= Tolerance);
+	}
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -4,6 +4,10 @@
 
 #include "CoreMinimal.h"
 #include "Modules/ModuleManager.h"
+#include "Stats/Stats.h"
+
+/** stat BlenderViewportControls */
+DECLARE_STATS_GROUP(TEXT("BlenderViewportControls"), STATGROUP_BlenderViewportControls, STATCAT_Advanced);
 
 class FBlenderViewportControlsModule : public IModuleInterface
 {
@@ -4,6 +4,10 @@
 
 #include "CoreMinimal.h"
 #include "EdMode.h"
+#include "BlenderViewportControls_Recorder.h"
+#include "BlenderViewportControls_Selection.h"
+
+enum class ETransformComponents : uint8;
 
 class FBlenderViewportControlsEdMode : public FEdMode
 {
@@ -17,15 +21,30 @@ public:
 	virtual void DrawHUD(FEditorViewportClient* ViewportClient, FViewport* Viewport, const FSceneView* View, FCanvas* Canvas);
 	virtual bool UsesTransformWidget() const override { return false; }
 	virtual bool InputKey(FEditorViewportClient* InViewportClient, FViewport* InViewport, FKey InKey, EInputEvent InEvent) override;
+	virtual bool MouseMove(FEditorViewportClient* InViewportClient, FViewport* InViewport, int32 InX, int32 InY) override;
 	bool UsesToolkits() const override { return false; }
 	// End of FEdMode interface
 
 	class ATransformGroupActor* GetTransformGroupActor() { return TransformGroupActor; }
+
+	/** Session recording and replay, see the BlenderViewportControls.StartRecording/StopRecording/Replay console commands */
+	void StartRecording();
+	void StopRecording(const FString& InFilename);
+	void StartReplay(const FString& InFilename);
+
+	/** 
+	* Moves every selected actor along InDirection onto the first surface it hits, keeping the surface snap offset.
+	* All actors are traced in one parallel batch and moved in one transaction.
+	*/
+	void DropSelectionToSurface(const FVector& InDirection, bool bAlignToNormal);
+
+	/** Randomizes the transforms of the selected actors in one transaction, see FGroupTransform::Randomize */
+	void RandomizeSelection(const FVector& InLocationRange, const FRotator& InRotationRange, const FVector& InScaleRange, bool bUniformScale, int32 InSeed);
 	
 protected:
 
-	/** Transform Reset Function */
-	void ResetSpecificActorTransform(void(*DoReset)(AActor*));
+	/** Resets the given parts of the transform of every selected actor in a single batched operation */
+	void ResetSpecificActorTransform(ETransformComponents InComponents);
 
 	bool IsOperationInProgress() { return ActiveToolMode ? true : false; };
 
@@ -37,6 +56,12 @@ protected:
 
 	void DuplicateSelection(FEditorViewportClient* InViewportClient);
 
+	/** Repeats the last accepted duplicate + transform InNumCopies times, every copy is offset from the previous one by the same delta */
+	void RepeatLastDuplicate(int32 InNumCopies);
+
+	/** Feeds the next recorded frame into the mode and times how long the mode takes for it */
+	void ReplayFrame(FEditorViewportClient* InViewportClient);
+
 	/** Delegate handle for registered selection change lambda */
 	FDelegateHandle SelectionChangedHandle;
 
@@ -47,4 +72,30 @@ private:
 
 	/** A helper actor to make transform operations easier */
 	class ATransformGroupActor* TransformGroupActor;
+
+	/** The last duplicate operation. Deltas are recorded whenever a transform of the duplicates is accepted */
+	struct FRepeatDuplicateRecord
+	{
+		TArray<TWeakObjectPtr<AActor>> Sources;
+		TArray<TWeakObjectPtr<AActor>> Duplicates;
+		TArray<FTransform> Deltas;
+
+		bool HasDelta() const { return Deltas.Num() > 0 && Deltas.Num() == Duplicates.Num(); }
+		void RecordDeltas();
+		void Reset() { Sources.Empty(); Duplicates.Empty(); Deltas.Empty(); }
+	};
+
+	FRepeatDuplicateRecord RepeatDuplicateRecord;
+
+	/** True while the mode changes the selection itself, so the selection changed delegate doesn't reset the repeat record */
+	bool bIsChangingSelection = false;
+
+	FToolSessionRecorder SessionRecorder;
+	FToolSessionReplayer SessionReplayer;
+
+	/** True while the replayer sends its recorded keys, any other input is ignored during a replay */
+	bool bIsReplayingInput = false;
+
+	/** Box (B) and circle (C) selection, only exists while the mode is active */
+	TUniquePtr<FViewportSelectionTool> SelectionTool;
 };
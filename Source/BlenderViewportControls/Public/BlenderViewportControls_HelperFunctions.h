@@ -23,9 +23,35 @@ struct FAxisLineDrawHelper
 	FLinearColor LineColor;
 };
 
+/** 
+* Everything needed to project between screen and world space in one viewport. Building a scene view is expensive, 
+* so the matrices are cached per viewport and only rebuilt when the camera or the viewport size changes.
+*/
+struct FViewportProjection
+{
+	FMatrix ViewProjectionMatrix = FMatrix::Identity;
+	FMatrix InvViewProjectionMatrix = FMatrix::Identity;
+	FIntRect ViewRect;
+
+	/** Returns true when the cached matrices still match the camera of InViewportClient */
+	bool IsValidFor(class FEditorViewportClient* InViewportClient) const;
+	void Update(class FEditorViewportClient* InViewportClient);
+
+private:
+	FVector ViewLocation = FVector::ZeroVector;
+	FRotator ViewRotation = FRotator::ZeroRotator;
+	float ViewFOV = 0.f;
+	float OrthoZoom = 0.f;
+	FIntPoint ViewportSize = FIntPoint::ZeroValue;
+	int32 ViewportType = INDEX_NONE;
+};
+
 class ToolHelperFunctions
 {
 public:
+	/** Cursor position in the pixel space of the viewport */
+	static FIntPoint GetCursorPosition(class FEditorViewportClient* InViewportClient);
+
 	static TTuple<FVector, FVector> GetCursorWorldPosition(class FEditorViewportClient* InViewportClient);
 	static TTuple<FVector, FVector> ProjectScreenPositionToWorld(class FEditorViewportClient* InViewportClient, const FIntPoint& InScreenPosition);
 
@@ -35,11 +61,52 @@ public:
 	/** InClampValues will clamp values so they can't be negative. Otherwise it is possible to have values that are outside of the viewport */
 	static FIntPoint ProjectWorldLocationToScreen(class FEditorViewportClient* InViewportClient, FVector InWorldSpaceLocation, bool InClampValues = false);
 
-	static FSceneView* GetSceneView(class FEditorViewportClient* InViewportClient);
+	/** Same projection with a copy of the viewport projection, safe to use off the game thread */
+	static FIntPoint ProjectWorldLocationToScreen(const FViewportProjection& InProjection, const FVector& InWorldSpaceLocation);
+
+	static const FViewportProjection& GetViewportProjection(class FEditorViewportClient* InViewportClient);
+
+	/** Drops the cached projections, closed viewports would otherwise stay in the cache */
+	static void ResetViewportProjections();
+
 	static class FBlenderViewportControlsEdMode* GetEdMode();
 	static class ATransformGroupActor* GetTransformGroupActor();
 	static FVector GetAverageLocation(const TArray<AActor*>& SelectedActors);
-	static void DrawAxisLine(const UWorld* InWorld, const FVector& InLineOrigin, const FVector& InLineDirection, const FLinearColor& InLineColor);
-	static void DrawDashedLine(FCanvas* InCanvas, const FVector& InLineStart, const FVector& InLineEnd, const float InLineThickness = 2.5f, const float InDashSize = 10.f, const FLinearColor& InLineColor = FLinearColor::White);
+	static TArray<AActor*> GetSelectedLevelActors();
+
+	/** InActors and everything attached to them, recursively. Attached actors move with their parents, so traces against the parents have to ignore them as well */
+	static TArray<AActor*> GetActorsWithAttachedActors(const TArray<AActor*>& InActors);
+
+	/** True for actors the viewport selection can pick: they have a root component, are visible and selectable, are no builder brush and are not in a locked level */
+	static bool IsSelectableInViewport(AActor* InActor);
+
+	/** Replaces the editor selection with InActors and only notifies the editor once */
+	static void SelectActors(const TArray<AActor*>& InActors);
+
+	/** Bytes held by all transactions in the editor undo buffer, cached until the buffer reports a change */
+	static SIZE_T GetUndoBufferSize();
+
+	/** 
+	* Spawns a copy of every actor with the actor itself as spawn template. Attachments between the copied actors are kept,
+	* instance components are copied, brushes get their own model and every copy gets a unique label.
+	* InSpawnTransforms optionally overrides the world transform of every copy, OutSources receives the source actor of every copy.
+	* Has to be called inside a transaction so the spawned actors can be undone.
+	*/
+	static TArray<AActor*> DuplicateActors(const TArray<AActor*>& InActors, const TArray<FTransform>* InSpawnTransforms = nullptr, TArray<AActor*>* OutSources = nullptr);
+
+	/** Screen space segment of the infinite world line through InLineOrigin that spans the viewport. False when the origin is behind the camera */
+	static bool ProjectWorldLineToScreen(class FEditorViewportClient* InViewportClient, const FVector& InLineOrigin, const FVector& InLineDirection, FVector2D& OutStart, FVector2D& OutEnd);
 	static FQuat FindActorAlignmentRotation(const FQuat& InActorRotation, const FVector& InModelAxis, const FVector& InWorldNormal);
+
+	/** 
+	* FindActorAlignmentRotation for every rotation and normal pair, solved four at a time in SIMD. 
+	* The automation test BlenderViewportControls.Kernels.AlignToNormalsBatch compares the results against the scalar version.
+	*/
+	static void FindActorAlignmentRotations(const TArray<FQuat>& InActorRotations, const FVector& InModelAxis, const TArray<FVector>& InWorldNormals, TArray<FQuat>& OutRotations);
+
+	/** 
+	* Traces from every start to its end against the visibility channel, ignoring InIgnoredActors. The traces run in parallel chunks,
+	* each under a read lock of the physics scene. OutHits has one entry per trace and bBlockingHit is false where nothing was hit.
+	*/
+	static void LineTraceBatch(const UWorld* InWorld, const TArray<FVector>& InStarts, const TArray<FVector>& InEnds, const TArray<AActor*>& InIgnoredActors, TArray<FHitResult>& OutHits);
 };
\ No newline at end of file
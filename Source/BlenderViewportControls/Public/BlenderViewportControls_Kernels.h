@@ -0,0 +1,122 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** Number of children processed per SIMD register by the batch kernels */
+static constexpr int32 ToolKernelLaneWidth = 4;
+
+/** 
+* Vectors stored as structure of arrays so batch kernels can load four children into one register per component.
+* The arrays are padded to the lane width, the padding is kept at zero.
+*/
+struct FVectorSoA
+{
+	void SetNum(int32 InNum);
+	void Set(int32 Index, const FVector3f& InVector);
+	FVector3f Get(int32 Index) const { return FVector3f(X[Index], Y[Index], Z[Index]); }
+
+	int32 Num() const { return NumElements; }
+	int32 NumPadded() const { return X.Num(); }
+	SIZE_T GetAllocatedSize() const { return X.GetAllocatedSize() + Y.GetAllocatedSize() + Z.GetAllocatedSize(); }
+
+	TArray<float> X;
+	TArray<float> Y;
+	TArray<float> Z;
+
+private:
+	int32 NumElements = 0;
+};
+
+/** Quaternions stored as structure of arrays, padded the same way as FVectorSoA */
+struct FQuatSoA
+{
+	void SetNum(int32 InNum);
+	void Set(int32 Index, const FQuat4f& InQuat);
+	FQuat4f Get(int32 Index) const { return FQuat4f(X[Index], Y[Index], Z[Index], W[Index]); }
+
+	int32 Num() const { return NumElements; }
+	int32 NumPadded() const { return X.Num(); }
+
+	TArray<float> X;
+	TArray<float> Y;
+	TArray<float> Z;
+	TArray<float> W;
+
+private:
+	int32 NumElements = 0;
+};
+
+/** Rotation packed into 64 bits: the three smallest components with 20 bits each and the index of the largest one, which is rebuilt from the others */
+struct FPackedQuat
+{
+	static FPackedQuat Pack(const FQuat4f& InQuat);
+	FQuat4f Unpack() const;
+
+	uint32 Packed[2] = { 0, 0 };
+};
+
+/** 
+* Per-child state the group kernels run on. The records are indexed like the actor table of the group, 
+* which is only touched when the operation writes back.
+*/
+struct FChildRecord
+{
+	/** Original location relative to the original pivot */
+	FVector3f Offset;
+	FPackedQuat Rotation;
+	FVector3f Scale;
+};
+static_assert(sizeof(FChildRecord) == 32, "FChildRecord should stay compact, selections can have millions of children");
+
+/** Local axes of every child, captured when the scale tool needs them */
+struct FChildBasisSoA
+{
+	void SetNum(int32 InNum);
+	void Set(int32 Index, const FQuat4f& InRotation);
+	int32 Num() const { return Forward.Num(); }
+	SIZE_T GetAllocatedSize() const { return Forward.GetAllocatedSize() + Right.GetAllocatedSize() + Up.GetAllocatedSize(); }
+
+	FVectorSoA Forward;
+	FVectorSoA Right;
+	FVectorSoA Up;
+};
+
+class ToolKernels
+{
+public:
+	/** Scalar version of BiasScaleBatch for a single rotation */
+	static FVector BiasScale(const FQuat& InRotation, const FVector& InScaleAxis, const FVector& InScale, bool bPlane);
+
+	/** 
+	* Blends InScale into every local axis of every child by how much that axis is aligned with InScaleAxis.
+	* When bPlane is true InScaleAxis is a plane normal and the blend uses how much the axis lies in that plane instead.
+	*/
+	static void BiasScaleBatch(const FChildBasisSoA& InBasis, const FVector3f& InScaleAxis, const FVector3f& InScale, bool bPlane, FVectorSoA& OutBiasScale);
+
+	/** OutOffsets = InRotation * Offset for every child */
+	static void RotateOffsetsBatch(const TArray<FChildRecord>& InRecords, const FQuat4f& InRotation, FVectorSoA& OutOffsets);
+
+	/** OutOffsets = Offset * InScale, component wise. The first version scales all children the same, the second one per child */
+	static void ScaleOffsetsBatch(const TArray<FChildRecord>& InRecords, const FVector3f& InScale, FVectorSoA& OutOffsets);
+	static void ScaleOffsetsBatch(const TArray<FChildRecord>& InRecords, const FVectorSoA& InScales, FVectorSoA& OutOffsets);
+
+	/** OutRotations = InLeft * Rotation * InRight for every child, InLeft rotates in world space and InRight in local space */
+	static void MultiplyRotationsBatch(const FQuat4f& InLeft, const TArray<FChildRecord>& InRecords, const FQuat4f& InRight, TArray<FQuat4f>& OutRotations);
+
+	/** 
+	* SIMD version of ToolHelperFunctions::FindActorAlignmentRotation for every rotation and normal pair, using the vector acos, atan2 and sincos approximations.
+	* Pairs where the model axis points exactly away from the normal are not solved, their indices are returned in OutScalarIndices.
+	*/
+	static void AlignToNormalsBatch(const FQuatSoA& InRotations, const FVectorSoA& InNormals, const FVector3f& InModelAxis, FQuatSoA& OutRotations, TArray<int32>& OutScalarIndices);
+
+	/** Random stream of an object, derived from its guid and InSeed so it is the same in every session */
+	static uint64 RandomStream(const FGuid& InGuid, int32 InSeed);
+
+	/** 
+	* Counter based random number in [-1, 1). Every number only depends on the stream and the counter, 
+	* so the results don't depend on which thread draws them or in which order.
+	*/
+	static float SignedRandom(uint64 InStream, uint32 InCounter);
+};
@@ -0,0 +1,122 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/Canvas.h"
+
+/** Screen space axis guide through the pivot */
+struct FToolOverlayAxis
+{
+	FVector2D Start;
+	FVector2D End;
+	FLinearColor Color;
+
+	bool operator==(const FToolOverlayAxis& Other) const { return Start == Other.Start && End == Other.End && Color == Other.Color; }
+};
+
+/** Everything the overlay geometry is built from. The geometry is only rebuilt when this changes */
+struct FToolOverlayState
+{
+	FIntPoint CursorPosition = FIntPoint::ZeroValue;
+	FIntPoint PivotPosition = FIntPoint::ZeroValue;
+	bool bDrawPivot = false;
+
+	/** Dashed line between the cursor and the pivot, used by the rotate and scale tools */
+	bool bDrawDashedLine = false;
+
+	TArray<FToolOverlayAxis, TInlineAllocator<2>> Axes;
+
+	bool operator==(const FToolOverlayState& Other) const
+	{
+		return CursorPosition == Other.CursorPosition && PivotPosition == Other.PivotPosition && bDrawPivot == Other.bDrawPivot
+			&& bDrawDashedLine == Other.bDrawDashedLine && Axes == Other.Axes;
+	}
+};
+
+/**
+* Tool HUD. All lines and markers are built into one persistent triangle list that is submitted to the canvas as a single batch,
+* instead of adding every dash as a separate line each frame. The readout text is the only thing drawn on its own.
+*/
+class FToolOverlay
+{
+public:
+	/** Rebuilds the geometry if InState differs from the state it was built from */
+	void Update(const FToolOverlayState& InState);
+	void SetReadout(const FString& InReadout) { Readout = InReadout; }
+
+	void Draw(FCanvas* Canvas) const;
+
+private:
+	void Rebuild();
+
+	void AddLine(const FVector2D& InStart, const FVector2D& InEnd, float InThickness, const FLinearColor& InColor);
+	void AddDashedLine(const FVector2D& InStart, const FVector2D& InEnd, float InThickness, float InDashSize, const FLinearColor& InColor);
+	void AddDiamond(const FVector2D& InCenter, float InRadius, const FLinearColor& InColor);
+	void AddTriangle(const FVector2D& InV0, const FVector2D& InV1, const FVector2D& InV2, const FLinearColor& InColor);
+
+	FToolOverlayState State;
+	bool bHasState = false;
+
+	TArray<FCanvasUVTri> Triangles;
+	FString Readout;
+};
+
+/** Parts of a tool update that are timed on their own, the rest of the update counts as math */
+enum class EToolPerfCategory : uint8
+{
+	Intersection,
+	SnapTraces,
+	WriteBack,
+	Num
+};
+
+/**
+* Cost of the active tool per frame for the performance overlay (BlenderViewportControls.ShowPerfOverlay). 
+* Nothing is timed while the overlay is off. The times are smoothed over a few frames so they can be read.
+*/
+class FToolPerfStats
+{
+public:
+	static FToolPerfStats& Get();
+	static bool IsEnabled();
+
+	void BeginFrame();
+	void EndFrame(double InUpdateSeconds);
+
+	void AddTime(EToolPerfCategory InCategory, double InSeconds) { FrameSeconds[(uint8)InCategory] += InSeconds; }
+	void AddTraces(int32 InNumTraces) { FrameTraces += InNumTraces; }
+
+	void Draw(FCanvas* Canvas, const FString& InOperationName, int32 InNumChildren, uint64 InUndoBytes) const;
+
+private:
+	double FrameSeconds[(uint8)EToolPerfCategory::Num] = {};
+	int32 FrameTraces = 0;
+
+	double SmoothedSeconds[(uint8)EToolPerfCategory::Num] = {};
+	double SmoothedMathSeconds = 0.0;
+	double SmoothedUpdateSeconds = 0.0;
+	int32 LastFrameTraces = 0;
+};
+
+/** Adds the time until it goes out of scope to InCategory of the current frame */
+class FToolPerfScope
+{
+public:
+	explicit FToolPerfScope(EToolPerfCategory InCategory)
+		: Category(InCategory), StartSeconds(FToolPerfStats::IsEnabled() ? FPlatformTime::Seconds() : 0.0)
+	{
+	}
+
+	~FToolPerfScope()
+	{
+		if (StartSeconds > 0.0)
+		{
+			FToolPerfStats::Get().AddTime(Category, FPlatformTime::Seconds() - StartSeconds);
+		}
+	}
+
+private:
+	EToolPerfCategory Category;
+	double StartSeconds;
+};
@@ -0,0 +1,90 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "InputCoreTypes.h"
+#include "BlenderViewportControls_Tools.h"
+
+/** Key event as the mode received it */
+struct FToolRecordedKey
+{
+	FString KeyName;
+	uint8 Event = 0;
+
+	friend FArchive& operator<<(FArchive& Ar, FToolRecordedKey& Key);
+};
+
+/** Input and camera of the recorded viewport for one frame, plus the key events the mode received during that frame */
+struct FToolRecordedFrame
+{
+	FToolInputState Input;
+	FVector ViewLocation = FVector::ZeroVector;
+	FRotator ViewRotation = FRotator::ZeroRotator;
+	float ViewFOV = 90.f;
+	TArray<FToolRecordedKey> Keys;
+
+	friend FArchive& operator<<(FArchive& Ar, FToolRecordedFrame& Frame);
+};
+
+/** A whole recorded session, the selection it started with and all frames */
+struct FToolRecordedSession
+{
+	FIntPoint ViewportSize = FIntPoint::ZeroValue;
+	TArray<FString> SelectedActorPaths;
+	TArray<FToolRecordedFrame> Frames;
+
+	bool Save(const FString& InFilename);
+	bool Load(const FString& InFilename);
+
+	friend FArchive& operator<<(FArchive& Ar, FToolRecordedSession& Session);
+};
+
+/**
+* Records the input stream of the mode to a binary file. Only the viewport the user works in is recorded,
+* that is the viewport the replay runs in later on.
+*/
+class FToolSessionRecorder
+{
+public:
+	void Start(class FEditorViewportClient* InViewportClient);
+
+	/** Writes the recording to InFilename and stops recording */
+	bool Stop(const FString& InFilename);
+	bool IsRecording() const { return RecordedViewportClient != nullptr; }
+
+	void RecordKey(class FEditorViewportClient* InViewportClient, const FKey& InKey, EInputEvent InEvent);
+	void RecordFrame(class FEditorViewportClient* InViewportClient);
+
+private:
+	FEditorViewportClient* RecordedViewportClient = nullptr;
+	FToolRecordedSession Session;
+	TArray<FToolRecordedKey> PendingKeys;
+};
+
+/**
+* Feeds a recorded session back into the mode, one recorded frame per tick, without any user input.
+* The time the mode spends on every frame and the final transforms of the selection are written next to the recording as a csv.
+*/
+class FToolSessionReplayer
+{
+public:
+	bool Start(const FString& InFilename, class FEditorViewportClient* InViewportClient);
+	bool IsReplaying() const { return ReplayedViewportClient != nullptr; }
+	bool IsReplayingIn(const FEditorViewportClient* InViewportClient) const { return ReplayedViewportClient == InViewportClient; }
+
+	/** Applies the camera and input of the next frame, returns its key events. Returns false when the session is over */
+	bool BeginFrame(TArray<FKey>& OutKeys, TArray<EInputEvent>& OutEvents);
+	void EndFrame(double InFrameSeconds);
+
+	/** Writes the results and restores the viewport input */
+	void Finish();
+
+private:
+	FEditorViewportClient* ReplayedViewportClient = nullptr;
+	FToolRecordedSession Session;
+	FString ResultFilename;
+	int32 FrameIndex = 0;
+	FToolInputState ReplayedInput;
+	TArray<double> FrameSeconds;
+};
@@ -0,0 +1,113 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "InputCoreTypes.h"
+#include "BlenderViewportControls_HelperFunctions.h"
+
+/**
+* Screen space bounds of every selectable actor in one viewport, bucketed into a uniform pixel grid.
+* The bounds are projected in one parallel batch, a query only tests the actors in the cells under the query shape.
+* The grid is only valid for the camera it was built with.
+*/
+class FScreenSpaceActorGrid
+{
+public:
+	void Build(class FEditorViewportClient* InViewportClient, float InCellSize);
+	void Invalidate() { bDirty = true; }
+
+	/** True when the grid was built in InViewportClient with its current camera and no actor changed since */
+	bool IsValidFor(class FEditorViewportClient* InViewportClient) const;
+
+	/** Actors whose screen bounds overlap the rectangle or the circle */
+	void QueryBox(const FBox2D& InBox, TArray<AActor*>& OutActors) const;
+	void QueryCircle(const FVector2D& InCenter, float InRadius, TArray<AActor*>& OutActors) const;
+
+	int32 Num() const { return Actors.Num(); }
+
+private:
+	FIntPoint GetCell(const FVector2D& InScreenPosition) const;
+
+	/** Calls InFunction once for every actor in the cells overlapping InBox */
+	template<typename FunctionType>
+	void ForEachActorInBox(const FBox2D& InBox, FunctionType&& InFunction) const;
+
+	const FEditorViewportClient* BuiltViewportClient = nullptr;
+	FViewportProjection BuiltProjection;
+	bool bDirty = true;
+
+	float CellSize = 0.f;
+	FIntPoint NumCells = FIntPoint::ZeroValue;
+
+	TArray<TWeakObjectPtr<AActor>> Actors;
+	TArray<FBox2D> ScreenBounds;
+
+	/** Actor indices sorted by cell, an actor is listed in every cell its bounds overlap */
+	TArray<int32> SortedIndices;
+
+	/** First index into SortedIndices for every cell in row order, plus one past the end */
+	TArray<int32> CellStarts;
+};
+
+/** What the selection tool is currently doing */
+enum class EViewportSelectionMode : uint8
+{
+	None,
+
+	/** B: drag a rectangle */
+	Box,
+
+	/** C: paint with a circle brush until the mode is left */
+	Circle
+};
+
+/**
+* Blender style box and circle selection. Dragging with the left mouse button adds to the selection, with shift held it removes from it.
+* The box mode ends when the rectangle is released, the circle mode with the right mouse button, Escape or Enter.
+*/
+class FViewportSelectionTool
+{
+public:
+	FViewportSelectionTool();
+	~FViewportSelectionTool();
+
+	void Begin(class FEditorViewportClient* InViewportClient, EViewportSelectionMode InMode);
+	void End();
+
+	bool IsActive() const { return Mode != EViewportSelectionMode::None; }
+	bool IsActiveIn(const FEditorViewportClient* InViewportClient) const { return IsActive() && ViewportClient == InViewportClient; }
+
+	/** Returns true when the key was used by the selection */
+	bool InputKey(class FEditorViewportClient* InViewportClient, const FKey& InKey, EInputEvent InEvent);
+
+	/** Paints the circle brush while the button is held */
+	void Tick(class FEditorViewportClient* InViewportClient);
+
+	void DrawHUD(class FCanvas* Canvas) const;
+
+private:
+	/** Rebuilds the grid if the camera moved */
+	void UpdateGrid();
+
+	/** Adds or removes InActors from the editor selection in one batch */
+	void ApplySelection(const TArray<AActor*>& InActors, bool bSelect);
+
+	EViewportSelectionMode Mode = EViewportSelectionMode::None;
+	FEditorViewportClient* ViewportClient = nullptr;
+
+	/** True while the mouse button is held, bDeselect when shift was down when it was pressed */
+	bool bDragging = false;
+	bool bDeselect = false;
+	FIntPoint DragStart = FIntPoint::ZeroValue;
+	FIntPoint LastPaintPosition = FIntPoint(-1, -1);
+
+	float CircleRadius = 0.f;
+
+	FScreenSpaceActorGrid Grid;
+
+	FDelegateHandle ActorMovedHandle;
+	FDelegateHandle ActorAddedHandle;
+	FDelegateHandle ActorDeletedHandle;
+	FDelegateHandle UndoRedoHandle;
+};
@@ -0,0 +1,37 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+enum class EToolSnapMode : uint8
+{
+	/** The offset from the start of the operation is snapped to increments along the world axes */
+	RelativeIncrement,
+
+	/** The length of the offset from the start of the operation is snapped to increments, the direction is kept */
+	AbsoluteIncrement,
+
+	/** The group origin lands on the world grid */
+	WorldGrid,
+
+	/** The offset from the start of the operation is snapped to increments along the local axes of the group */
+	LocalGrid
+};
+
+/**
+* Snapping for the accumulated delta of an operation. The group delta is snapped once per frame and then fanned out to the children,
+* so snapping never adds per child cost. Snapping the accumulated delta instead of the per frame delta keeps precision mode working with it.
+*/
+class ToolSnapping
+{
+public:
+	/** Snap mode selected with BlenderViewportControls.SnapMode */
+	static EToolSnapMode GetSnapMode();
+
+	/** InOffset is the accumulated offset, InOrigin the group origin and InLocalRotation the group rotation when the operation started */
+	static FVector SnapOffset(const FVector& InOffset, const FVector& InOrigin, const FQuat& InLocalRotation, float InIncrement, EToolSnapMode InMode);
+
+	/** InMultiplier is the accumulated scale multiplier, InReferenceScale the scale of the group when the operation started */
+	static float SnapScale(float InMultiplier, float InReferenceScale, float InIncrement, EToolSnapMode InMode);
+};
@@ -0,0 +1,52 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+* Uniform grid over a set of world space points. Built once per operation and queried every frame, 
+* a query only visits the cells overlapping the query volume instead of every point.
+* The point indices are stored sorted by cell so the points of one cell are contiguous.
+*/
+class FSpatialPointGrid
+{
+public:
+	void Build(TArray<FVector>&& InPoints, float InCellSize);
+	void Reset();
+
+	bool IsBuilt() const { return CellSize > 0.f; }
+	int32 Num() const { return Points.Num(); }
+	const FVector& GetPoint(int32 Index) const { return Points[Index]; }
+	float GetCellSize() const { return CellSize; }
+
+	/** Adds the indices of all points within InRadius of InCenter */
+	void QuerySphere(const FVector& InCenter, float InRadius, TArray<int32>& OutIndices) const;
+
+	/** 
+	* Returns the point closest to the ray within a cone around it, INDEX_NONE if there is none. The cone radius is InRadius plus InRadiusPerDistance
+	* per unit along the ray, so a perspective cone covers the same screen radius at every depth and an orthographic one (no radius per distance) is a cylinder.
+	* Points are ranked by their distance to the ray relative to the cone radius at their depth, i.e. by screen distance. Closer points win ties.
+	*/
+	int32 FindNearestToRay(const FVector& InRayOrigin, const FVector& InRayDirection, float InRadius, float InRadiusPerDistance) const;
+
+private:
+	FIntVector GetCell(const FVector& InLocation) const;
+
+	template<typename FunctionType>
+	void ForEachPointInSphere(const FVector& InCenter, float InRadius, FunctionType&& InFunction) const;
+
+	/** Calls InFunction with the first sorted index and the number of points of every occupied cell that overlaps the cone */
+	template<typename FunctionType>
+	void ForEachCellInCone(const FVector& InRayOrigin, const FVector& InRayDirection, double InRadius, double InRadiusPerDistance, FunctionType&& InFunction) const;
+
+	float CellSize = 0.f;
+	TArray<FVector> Points;
+	FBox Bounds = FBox(ForceInit);
+
+	/** Point indices sorted by cell */
+	TArray<int32> SortedIndices;
+
+	/** First index into SortedIndices and number of points for every occupied cell */
+	TMap<FIntVector, TPair<int32, int32>> Cells;
+};
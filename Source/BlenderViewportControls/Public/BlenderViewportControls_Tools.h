@@ -3,8 +3,15 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "BlenderViewportControls_Kernels.h"
+#include "BlenderViewportControls_SpatialIndex.h"
+#include "InputCoreTypes.h"
+#include "BlenderViewportControls_Overlay.h"
+#include "Tasks/Task.h"
 
 struct FAxisLineDrawHelper;
+struct FViewportProjection;
+DECLARE_LOG_CATEGORY_EXTERN(LogBlenderTool, Display, All);
 DECLARE_LOG_CATEGORY_EXTERN(LogMoveTool, Display, All);
 DECLARE_LOG_CATEGORY_EXTERN(LogRotateTool, Display, All);
 DECLARE_LOG_CATEGORY_EXTERN(LogScaleTool, Display, All);
@@ -29,24 +36,98 @@ struct FAxisLockHelper
 	bool IsLocked() const { return CurrentLockedAxis != None; }
 };
 
-struct FGroupTransform
+/** 
+* Cursor and modifier state the tools and the mode react to. It is sampled from the viewport, 
+* except while a recorded session is replayed, then the replayer provides it.
+*/
+struct FToolInputState
 {
-	struct FChildTransform
-	{
-		FChildTransform(AActor* InActor, const FIntPoint& InScreenSpaceOffset)
-			: Actor(InActor), ChildOriginalTransform(InActor->GetTransform()), ScreenSpaceOffset(InScreenSpaceOffset) {};
+	FIntPoint CursorPosition = FIntPoint::ZeroValue;
+	bool bShiftDown = false;
+	bool bCtrlDown = false;
+	bool bAltDown = false;
+
+	static FToolInputState Get(class FEditorViewportClient* InViewportClient);
+
+	/** While set, Get returns InReplayedInput instead of sampling the viewport. Pass nullptr to go back to the viewport */
+	static void SetReplayedInput(const FToolInputState* InReplayedInput);
+};
+
+/** Value typed while a tool is active, e.g. G X 250 or R Z 90 */
+struct FToolNumericInput
+{
+	/** Returns true when InKey edits the value (digits, period, minus and backspace) */
+	bool HandleKey(const FKey& InKey);
+
+	bool IsActive() const { return !Digits.IsEmpty() || bNegative; }
+	float GetValue() const;
+
+	/** Value as typed, used for the viewport readout */
+	FString ToString() const;
+
+private:
+	FString Digits;
+	bool bNegative = false;
+};
+
+/** 
+* Update kernels are template instances selected once whenever the axis lock (or the trackball toggle) changes,
+* so the per-frame update and the per-child loops don't have to branch on that state.
+* Modifiers can change on any frame, they are sampled once per frame and passed to the kernel.
+*/
+enum class EMoveKernel : uint8
+{
+	Free,
+	Axis,
+	Plane
+};
+
+enum class ERotateKernel : uint8
+{
+	Free,
+	Axis,
+	TrackBall
+};
+
+enum class EScaleKernel : uint8
+{
+	Uniform,
+	Axis,
+	Plane
+};
+
+/** What the rotate and scale tools work around */
+enum class EToolPivotMode : uint8
+{
+	/** One pivot at the median of the selection */
+	Median,
+
+	/** Every child around its own origin, in its own local axes */
+	IndividualOrigins
+};
 
-		AActor* Actor;
-		FTransform ChildOriginalTransform;
-		FVector RelativeOffset;
-		FIntPoint ScreenSpaceOffset;
-	};
+/** Parts of the child transforms that an operation writes back to the actors */
+enum class ETransformComponents : uint8
+{
+	None = 0,
+	Location = 1 << 0,
+	Rotation = 1 << 1,
+	Scale = 1 << 2,
+	All = Location | Rotation | Scale
+};
+ENUM_CLASS_FLAGS(ETransformComponents);
 
+struct FGroupTransform
+{
 	void SetAverageLocation();
 
 	FVector GetOriginLocation() const { return Parent.GetLocation(); }
+	FVector GetOriginalOriginLocation() const { return ParentOriginalTransform.GetLocation(); }
 	FTransform GetParentTransform() const { return Parent; };
 
+	/** Uniform scale the absolute scale snapping is based on */
+	float GetReferenceScale() const { return ChildRecords.Num() > 0 ? ChildRecords[0].Scale.X : 1.f; }
+
 	FVector GetLocalForwardVector() const { return Parent.GetRotation().GetForwardVector(); };
 	FVector GetLocalRightVector() const { return Parent.GetRotation().GetRightVector(); };
 	FVector GetLocalUpVector() const { return Parent.GetRotation().GetUpVector(); };
@@ -54,32 +135,254 @@ struct FGroupTransform
 	static void SetTransform(FTransform InTransform) {}
 	void AddRotation(const FRotator& InAddRotation);
 	void SetLocation(const FVector& InNewLocation);
+
+	/** Rotates the children from their original transforms, AddRotation accumulates on top of the current rotation */
+	void SetRotation(const FQuat& InRotation);
+	FQuat GetAccumulatedRotation() const { return AccumulatedRotation; }
 	void AddLocation(const FVector& InOffset);
-	void SetScale(const FVector& InNewScale, const FVector& ScaleAxis, bool bUniformScale);
-	void AddChild(AActor* NewChild, const FIntPoint& InScreenspaceOffset);
+
+	/** ScaleAxis is the locked axis for the Axis kernel and the plane normal for the Plane kernel */
+	void SetScale(const FVector& InNewScale, const FVector& ScaleAxis, EScaleKernel InKernel);
+
+	/** Resets the given parts of every child to identity. Other parts of the transforms are left untouched, so it doesn't need the original transforms */
+	void ResetTransforms(ETransformComponents InComponents);
+
+	/** 
+	* Offsets every child from its original transform by a random amount within the given ranges. InLocationRange is in world space,
+	* InRotationRange in the local space of each child and InScaleRange is relative to the original scale.
+	* Every child draws from its own stream based on its guid and InSeed, so the result only depends on the actor and the seed.
+	*/
+	void Randomize(const FVector& InLocationRange, const FRotator& InRotationRange, const FVector& InScaleRange, bool bUniformScale, int32 InSeed);
+
+	/** 
+	* Writes the given parts of InTransforms to the children, one transform per child in the order they were added.
+	* Proportionally edited actors follow the average displacement of the children.
+	*/
+	void SetTransforms(const TArray<FTransform>& InTransforms, ETransformComponents InComponents);
+
+	void AddChild(AActor* NewChild);
+
+	/** InTransform is the transform the child has when the group is set up, the actor itself is not read */
+	void AddChild(AActor* NewChild, const FTransform& InTransform);
+
+	/** Adds children without capturing their transforms. Such a group needs no setup, but only ResetTransforms works on it */
+	void AddResetChildren(const TArray<AActor*>& InActors);
+	void SetPivotMode(EToolPivotMode InPivotMode) { PivotMode = InPivotMode; }
 	void FinishSetup(FEditorViewportClient* InViewportClient);
 
+	/** Setup without a viewport for scripted operations. The group works around InPivot instead of the average location of the children */
+	void FinishSetup(const UWorld* InWorld, const FVector& InPivot);
+
+	/** Setup against a copy of the viewport projection. Only works on the transforms passed to AddChild, so it can run on a worker thread */
+	void FinishSetup(const UWorld* InWorld, const FViewportProjection& InProjection, const FIntPoint& InCursorPosition);
+
+	/** Setup without children, the group only moves its origin from InPivot until the tool replaces it with the real group */
+	void SetupEstimate(FEditorViewportClient* InViewportClient, const FVector& InPivot);
+
+	/** Recomputes the screen space offsets of the origin and the children in InViewportClient */
+	void UpdateScreenSpace(FEditorViewportClient* InViewportClient, const FIntPoint& InCursorPosition);
+	void UpdateScreenSpace(const FViewportProjection& InProjection, const FIntPoint& InCursorPosition);
+
+	/** 
+	* Proportional editing: actors within InRadius of any child follow the group transform, weighted by a smooth falloff of their distance
+	* to the closest child. The actor locations are hashed once per operation, changing the radius only queries the hash again.
+	* Candidates are the actors the viewport selection could pick, without landscapes, volumes, lights and sky actors.
+	*/
+	void SetProportionalRadius(float InRadius);
+	void ClearProportionalChildren();
+
+	/** Restores the original transforms of the proportionally edited actors */
+	void RestoreProportionalChildren();
+
+	/** Restores the actors that the transaction could not record, cancelling the transaction restores all others */
+	void RestoreUnrecordedActors();
+
+	/** Removes the children at InChildIndices, which have to be ascending. Only valid before the group first writes back */
+	void RemoveChildren(const TArray<int32>& InChildIndices);
+
+	/** Memory of the per-child state, reported in stat BlenderViewportControls */
+	SIZE_T GetAllocatedSize() const;
+
 public:
-	int32 GetNumChildren() const { return Children.Num(); }
+	int32 GetNumChildren() const { return ChildActors.Num(); }
 	FIntPoint GetScreenSpaceOffset() const { return ScreenSpaceParentCursorOffset; }
-	TArray<FChildTransform> GetChildren() { return Children; }
-	TArray<AActor*> GetAllChildActors();
+	const TArray<AActor*>& GetAllChildActors() const { return ChildActors; }
+
+	/** Screen space offset of every child to the cursor, in the order of GetAllChildActors */
+	const TArray<FIntPoint>& GetChildScreenSpaceOffsets() const { return ChildScreenSpaceOffsets; }
+
+	/** Children and proportionally edited actors */
+	TArray<AActor*> GetAllAffectedActors();
 	FIntPoint GetOriginScreenLocation() const { return OriginScreenLocation; }
 
 private:
+	/** Captures the pivot relative child data the kernels run on, the pivot has to be set already */
+	void CaptureChildren(const UWorld* InWorld);
+
+	/** Screen space offsets of the origin and the children, GetChildLocation returns the world location of a child */
+	template<typename GetChildLocationType>
+	void ProjectChildren(const FViewportProjection& InProjection, const FIntPoint& InCursorPosition, GetChildLocationType&& GetChildLocation);
+
+	template<EScaleKernel Kernel>
+	void SetScaleKernel(const FVector& InNewScale, const FVector& ScaleAxis);
+
+	/** 
+	* Applies the kernel outputs, or InTransforms when given, to the actors. This is the only place that writes to the actors, 
+	* InComponents decides which setter is used so unrelated parts of the transforms are never touched.
+	*/
+	void WriteBack(ETransformComponents InComponents, const TArray<FTransform>* InTransforms = nullptr);
+	void WriteTargets(ETransformComponents InComponents);
+
+	/** Records the proportionally edited actors that just joined and writes the weighted group transform to all of them */
+	void WriteProportionalActors(ETransformComponents InComponents);
+	static void WriteTransforms(const TArray<AActor*>& InActors, const TArray<FTransform>& InTransforms, ETransformComponents InComponents);
+
+	FVector GetTargetLocation(int32 ChildIndex) const
+	{
+		return TargetPivot + FVector(bTargetOffsetsFromRecords ? ChildRecords[ChildIndex].Offset : ChildTargetOffsets.Get(ChildIndex));
+	}
+
+	/** Weighted version of the current group delta for every proportionally edited actor */
+	void PrepareProportionalTargets();
+
+	/** Records InActor in the transaction before its first write, or keeps its transform when the transaction can't record it */
+	void RecordActor(AActor* InActor);
+
 	FTransform Parent;
 	FTransform ParentOriginalTransform;
+	FQuat AccumulatedRotation = FQuat::Identity;
 	FIntPoint ScreenSpaceParentCursorOffset;
 	FIntPoint OriginScreenLocation;
-	TArray<FChildTransform> Children;
 	const UWorld* CurrentWorld;
+
+	/**
+	* One record per child with the location relative to the original pivot, the rotation and the scale in single precision. The kernels only work on these,
+	* the pivot stays in world doubles and is added back when the target transforms are built, so groups far from the origin keep their precision.
+	*/
+	TArray<FChildRecord> ChildRecords;
+
+	/** The actor of every record. Cancelling restores the actors from the transaction, so no exact copy of the original transforms is kept for the actors it recorded */
+	TArray<AActor*> ChildActors;
+
+	/** Children and proportionally edited actors the transaction did not record, with their original transforms. Usually empty */
+	TArray<AActor*> UnrecordedActors;
+	TArray<FTransform> UnrecordedTransforms;
+
+	/** Transforms of the children added so far, turned into records and freed by CaptureChildren */
+	TArray<FTransform> PendingChildTransforms;
+
+	/** Only used by surface snapping, filled by UpdateScreenSpace */
+	TArray<FIntPoint> ChildScreenSpaceOffsets;
+
+	/** Original local axes of the children and the scratch output of the axis scale kernels, only built for the axis and plane scale kernels */
+	FChildBasisSoA ChildBasis;
+	FVectorSoA ChildBiasScale;
+
+	/** 
+	* Scratch output of the kernels, written straight to the actors by WriteBack. The target locations are the offsets added to TargetPivot, 
+	* which stays in world doubles. Moving only changes the pivot, the offsets are then taken from the records.
+	*/
+	FVector TargetPivot = FVector::ZeroVector;
+	bool bTargetOffsetsFromRecords = false;
+	FVectorSoA ChildTargetOffsets;
+	TArray<FQuat4f> ChildTargetRotations;
+	FVectorSoA ChildTargetScales;
+
+	/**
+	* With individual origins the children keep their locations. The group rotation is applied to every child in world space around its own origin,
+	* the group scale is blended into the local axes of every child by how they line up with the locked axis, the same way it is around the median.
+	*/
+	EToolPivotMode PivotMode = EToolPivotMode::Median;
+
+	/** The children only need to be recorded in the transaction once per operation */
+	bool bChildrenModified = false;
+
+	/** Current scale of the group, kept so the proportionally edited actors can be scaled with their weight */
+	FVector CurrentScale = FVector::OneVector;
+	FVector CurrentScaleAxis = FVector::ZeroVector;
+	EScaleKernel CurrentScaleKernel = EScaleKernel::Uniform;
+
+	/** Locations of all actors that could be proportionally edited, ProportionalCandidates is indexed by the grid point indices */
+	FSpatialPointGrid ProportionalGrid;
+	TArray<AActor*> ProportionalCandidates;
+
+	TArray<AActor*> ProportionalActors;
+	TArray<FTransform> ProportionalOriginalTransforms;
+	TArray<float> ProportionalWeights;
+	TArray<FTransform> ProportionalTargetTransforms;
+	TSet<AActor*> ModifiedProportionalActors;
+};
+
+/** 
+* Keeps the editor from reacting to every single actor movement while a tool is live (navigation rebuilds, lighting invalidation,
+* HLOD and level bounds updates). The reactions are issued once for all moved actors when the operation is committed.
+*/
+class FToolDragSession
+{
+public:
+	explicit FToolDragSession(UWorld* InWorld);
+	~FToolDragSession();
+
+	/** Sends one finished PostEditMove to every moved actor and releases the navigation lock so all dirty areas are rebuilt in one batch */
+	void Commit(const TArray<AActor*>& InMovedActors);
+
+private:
+	TUniquePtr<struct FNavigationLockContext> NavigationLock;
+};
+
+/** 
+* Tints the selection outline while a tool is active. The outline color is only written when it actually changes 
+* and large selections keep their color (BlenderViewportControls.OutlineTintMaxActors).
+*/
+class FToolOutlineTint
+{
+public:
+	void Apply(int32 InNumSelectedActors);
+
+	/** Restores the color from before Apply, does nothing if Apply skipped the tint */
+	void Restore();
+
+private:
+	TOptional<FLinearColor> SavedColor;
+};
+
+/** 
+* Handles and transforms of the actors a group is built from, the only part taken on the game thread.
+* Everything else, including the attachment filter, runs where the group is built, which can be a worker thread.
+*/
+struct FToolGroupSource
+{
+	void Capture(const TArray<AActor*>& InActors);
+
+	/** 
+	* Indices of the actors whose attach parents are not part of the source as well. 
+	* Attached children follow their parent anyway, transforming them explicitly would move them twice.
+	* Only reads actors that are still valid and blocks garbage collection while it does, so it can run on any thread.
+	*/
+	TArray<int32> GetRootIndices() const;
+
+	/** Off the game thread the actors are only read by GetRootIndices, otherwise they are only compared and handed on */
+	TArray<AActor*> Actors;
+	TArray<TWeakObjectPtr<AActor>> WeakActors;
+	TArray<FTransform> Transforms;
+};
+
+/** Group of a tool and what was skipped while building it */
+struct FToolGroupBuild
+{
+	TSharedPtr<FGroupTransform> Group;
+	int32 NumSkippedAttachedActors = 0;
+
+	/** The actor of every child, so actors that were deleted while the group was built can be dropped */
+	TArray<TWeakObjectPtr<AActor>> ChildWeakActors;
 };
 
 class FBlenderToolMode
 {
 public:
-	FBlenderToolMode(class FEditorViewportClient* InViewportClient, const FText& InOperationName)
-		: ToolViewportClient(InViewportClient), OperationName(InOperationName)
+	/** InActors are the actors to transform. When empty the tool operates on the current editor selection */
+	FBlenderToolMode(class FEditorViewportClient* InViewportClient, const FText& InOperationName, const TArray<AActor*>& InActors = TArray<AActor*>())
+		: ToolViewportClient(InViewportClient), ToolActors(InActors), OperationName(InOperationName)
 	{
 		FBlenderToolMode::ToolBegin();
 	}
@@ -88,71 +391,134 @@ public:
 	* Canceling any transaction in the destructor ensures that we don't enter some undefined transaction state.
 	* Regular transaction closing is handled by ToolClose() 
 	*/
-	virtual ~FBlenderToolMode() { GEditor->CancelTransaction(0); }
+	virtual ~FBlenderToolMode()
+	{
+		// The worker still reads the actors
+		if (bGroupPending)
+		{
+			PendingGroup.Wait();
+		}
+
+		GEditor->CancelTransaction(0);
+	}
 
 	// Main tool functions
 	virtual void ToolBegin();
 	virtual void ToolUpdate() {};
 	virtual void ToolClose(bool Success);
 
-	virtual void DrawHUD(FEditorViewportClient* ViewportClient, FViewport* Viewport, const FSceneView* View, FCanvas* Canvas) {}
+	/** Runs the cursor driven ToolUpdate unless a typed value has taken over */
+	void ToolTick();
 
-	struct FSelectionToolHelper
-	{
-		FSelectionToolHelper(AActor* InActor, const FTransform& InTransform)
-			: Actor(InActor), DefaultTransform(InTransform) {};
+	/** 
+	* Large selections start with a group that has no children yet and moves around the editor pivot, the real group is built on a worker thread.
+	* Until it is ready the tool only collects input (BlenderViewportControls.ProgressiveStartupMinActors).
+	*/
+	bool IsGroupReady() const { return !bGroupPending; }
 
-		AActor* Actor;
-		FTransform DefaultTransform;
-	};
+	/** Draws the tool overlay, the overlay geometry is only rebuilt when the state it is built from changes */
+	virtual void DrawHUD(FEditorViewportClient* ViewportClient, FViewport* Viewport, const FSceneView* View, FCanvas* Canvas);
 
-	TArray<AActor*> GetSelectedActors() 
-	{
-		TArray<AActor*> Actors;
-		for (auto& Info : SelectionInfos)
-		{
-			Actors.Add(Info.Actor);
-		}
-		
-		return Actors;
-	}
+	/** Draws what the operation costs per frame (BlenderViewportControls.ShowPerfOverlay) */
+	void DrawPerfOverlay(FCanvas* Canvas);
 
 	FVector GetCameraForwardVector() const { return ToolViewportClient->GetViewRotation().Vector(); }
 	TSharedPtr<FGroupTransform> GetGroupTransform() { return GroupTransform; }
 
 	virtual void SetAxisLock(const EToolAxisLock& InAxisToLock, bool bDualAxis);
 	virtual void AddSnapOffset(const float InOffset);
-	bool IsSingleSelection() const { return SelectionInfos.Num() == 1; }
+
+	/** Distance along the surface normal that surface snapping keeps, changed with Ctrl + scroll while moving */
+	static float GetSnapOffset();
+	bool IsSingleSelection() const { return GroupTransform->GetNumChildren() == 1; }
+	int32 GetNumSkippedAttachedActors() const { return NumSkippedAttachedActors; }
 	FText GetOperationName() const { return OperationName; }
-	FIntPoint GetCursorPosition() const { return ToolViewportClient->GetCursorWorldLocationFromMousePos().GetCursorPos(); }
-	bool IsPrecisionModeActive() const { return ToolViewportClient->IsShiftPressed(); }
+	FToolInputState GetInputState() const;
+	FIntPoint GetCursorPosition() const { return GetInputState().CursorPosition; }
+
+	/** The viewport the tool follows the cursor in, it changes when the cursor moves into another viewport */
+	FEditorViewportClient* GetViewportClient() const { return ToolViewportClient; }
+	void SetViewportClient(FEditorViewportClient* InViewportClient);
+	bool IsPrecisionModeActive() const { return GetInputState().bShiftDown; }
+
+	/** Proportional editing persists between operations, like the surface snap offset */
+	static bool IsProportionalEditing();
+	static void SetProportionalEditing(bool bEnabled);
+
+	/** The pivot mode persists between operations as well, it is picked up when a tool begins */
+	static EToolPivotMode GetPivotMode();
+	static void SetPivotMode(EToolPivotMode InPivotMode);
+
+	/** Grows the proportional editing radius for positive InSteps and shrinks it for negative ones */
+	void AddProportionalRadius(float InSteps);
+
+	/** Applies the current proportional editing state and radius to the group */
+	void UpdateProportionalEditing();
+
+	/** 
+	* Typed input. While a value is typed the cursor is ignored and the value is applied once as an exact delta from the original
+	* transforms, so the tool costs nothing per frame until the input or the axis lock changes.
+	*/
+	bool HandleNumericInput(const FKey& InKey);
+	bool IsNumericInputActive() const { return NumericInput.IsActive(); }
+
+	/** Applies the typed value again, needed when the axis lock changed */
+	void RefreshNumericInput();
 
 protected:
 
+	/** Resolves the lock vectors and axis lines for the current lock. Only needs to run when the lock changes */
 	void CalculateAxisLock();
 
-	/** Draws the lines in the viewport that are visible when an axis lock is active */
-	virtual void DrawAxisLocks();
+	/** Fills the overlay state, the base version adds the pivot marker and the axis lock guides */
+	virtual void BuildOverlayState(FToolOverlayState& OutState) const;
+
+	/** Text next to the cursor, the typed value or the current delta of the operation */
+	virtual FString GetReadout() const;
+
+	/** Applies InValue along the current axis lock, the unit depends on the tool */
+	virtual void ApplyNumericInput(float InValue) {}
+
+	/** Called when the typed value was erased and the cursor drives the tool again */
+	virtual void ResumeCursorInput() { ReanchorCursor(); }
+
+	/** Restarts the cursor tracking of the tool from the current cursor position, e.g. after switching viewports */
+	virtual void ReanchorCursor() {}
+
+	/** Swaps in the group built on the worker thread and applies the input the tool collected in the meantime */
+	void OnGroupReady();
 
 	FEditorViewportClient* ToolViewportClient;
+	TArray<AActor*> ToolActors;
 	TSharedPtr<FGroupTransform> GroupTransform;
-	TArray<FSelectionToolHelper> SelectionInfos;
 	FAxisLockHelper AxisLockHelper;
 	float SnapOffset = 0.f;
+	int32 NumSkippedAttachedActors = 0;
+	FToolNumericInput NumericInput;
 	
 private:
 	
 	const FText OperationName;
-	FLinearColor DefaultSelectionOutlineColor;
+	FToolOutlineTint OutlineTint;
+	UE::Tasks::TTask<FToolGroupBuild> PendingGroup;
+	bool bGroupPending = false;
+
+	/** The screen space offsets of the built group are from the viewport the tool started in */
+	bool bViewportChangedWhilePending = false;
+	TUniquePtr<FToolDragSession> DragSession;
 	TArray<FAxisLineDrawHelper> AxisLineDrawHelper;
+	FToolOverlay Overlay;
+
+	/** Size of the undo buffer before the operation, the overlay shows what the operation added to it */
+	TOptional<SIZE_T> UndoSizeBeforeTool;
 };
 
 class FMoveMode : public FBlenderToolMode
 {
 public:
 
-	FMoveMode(FEditorViewportClient* InViewportClient, const FText& InOperationName)
-		:FBlenderToolMode(InViewportClient, InOperationName)
+	FMoveMode(FEditorViewportClient* InViewportClient, const FText& InOperationName, const TArray<AActor*>& InActors = TArray<AActor*>())
+		:FBlenderToolMode(InViewportClient, InOperationName, InActors)
 	{
 		FMoveMode::ToolBegin();
 	}
@@ -163,13 +529,48 @@ public:
 
 	virtual void SetAxisLock(const EToolAxisLock& InAxisToLock, bool bDualAxis) override;
 
-	bool IsSurfaceSnapping() const { return ToolViewportClient->IsCtrlPressed(); }
+	/** Ctrl snaps like it does while scaling, BlenderViewportControls.MoveSnapTarget decides whether to surfaces or to increments */
+	bool IsSurfaceSnapping() const;
+	bool IsIncrementSnapping() const;
+	static bool IsSurfaceSnapTarget();
+
+	/** Snaps the group origin to the origins (and optionally vertices) of other visible actors */
+	bool IsPointSnapping() const { return GetInputState().bAltDown; }
 	FVector GetIntersection() const;
 
+protected:
+	virtual void ApplyNumericInput(float InValue) override;
+	virtual void ResumeCursorInput() override;
+	virtual void ReanchorCursor() override;
+	virtual FString GetReadout() const override;
+
 private:
 
+	/** Collects the snap points of all visible actors that are not part of the operation, only done once per operation */
+	void BuildSnapPointGrid();
+
+	/** Finds the snap point closest to the cursor ray at any depth, within SnapPointScreenRadius pixels of the cursor */
+	bool FindSnapPoint(const FIntPoint& InCursorPosition, FVector& OutSnapPoint);
+
+	/** Picks the update function for the current axis lock, only runs when the lock changes */
+	void SelectKernel();
+
+	/** The update of one lock state, the lock is a template parameter so the update doesn't branch on it */
+	template<EMoveKernel Kernel>
+	void UpdateKernel(const FToolInputState& InInput);
+
+	template<EMoveKernel Kernel>
+	FVector GetIntersectionKernel(const FIntPoint& InCursorPosition) const;
+
+	EMoveKernel ActiveKernel = EMoveKernel::Free;
+	void (FMoveMode::*ActiveUpdate)(const FToolInputState&) = nullptr;
 	FIntPoint ScreenSpaceOriginOffset;
 	FVector LastFrameCursorPosition;
+
+	/** Offset of the group since the operation started, before snapping */
+	FVector AccumulatedOffset = FVector::ZeroVector;
+
+	FSpatialPointGrid SnapPointGrid;
 	bool bForceAxisLockLastFrameUpdate = true;
 	bool bFirstUpdate = true;
 };
@@ -178,8 +579,8 @@ class FRotateMode : public FBlenderToolMode
 {
 public:
 
-	FRotateMode(FEditorViewportClient* InViewportClient, const FText& InOperationName)
-		:FBlenderToolMode(InViewportClient, InOperationName)
+	FRotateMode(FEditorViewportClient* InViewportClient, const FText& InOperationName, const TArray<AActor*>& InActors = TArray<AActor*>())
+		:FBlenderToolMode(InViewportClient, InOperationName, InActors)
 	{
 		FRotateMode::ToolBegin();
 	}
@@ -188,15 +589,32 @@ public:
 	virtual void ToolUpdate() override;
 	virtual void ToolClose(bool Success) override;
 
-	virtual void DrawHUD(FEditorViewportClient* ViewportClient, FViewport* Viewport, const FSceneView* View, FCanvas* Canvas) override;
 	virtual void SetAxisLock(const EToolAxisLock& InAxisToLock, bool bDualAxis) override;
 
-	void ToggleTrackBallRotation() { IsTrackBallRotating = !IsTrackBallRotating; };
+	void ToggleTrackBallRotation();
 	FVector GetIntersection();
 
+protected:
+	virtual void ApplyNumericInput(float InValue) override;
+	virtual void ResumeCursorInput() override;
+	virtual void ReanchorCursor() override;
+	virtual void BuildOverlayState(FToolOverlayState& OutState) const override;
+	virtual FString GetReadout() const override;
+
 private:
 
-	void GetTrackballAngleAndAxis(FVector& OutAxis, float& OutAngle);
+	/** Picks the update function for the current axis lock and trackball state, only runs when they change */
+	void SelectKernel();
+
+	/** The update of one rotate kernel, the kernel is a template parameter so the update doesn't branch on it */
+	template<ERotateKernel Kernel>
+	void UpdateKernel(const FToolInputState& InInput);
+
+	FVector GetIntersection(const FIntPoint& InCursorPosition) const;
+	void GetTrackballAngleAndAxis(const FIntPoint& InCursorPosition, FVector& OutAxis, float& OutAngle);
+
+	ERotateKernel ActiveKernel = ERotateKernel::Free;
+	void (FRotateMode::*ActiveUpdate)(const FToolInputState&) = nullptr;
 
 	FVector TrackBallLastFrameVector;
 
@@ -208,14 +626,17 @@ private:
 	float CurrentAngleIncrement = 0.f;
 	const float AngleSnapStep = 11.25f;
 	float LastFrameAngle = 0.f;
+
+	/** Rotation the cursor produced before a value was typed, restored when the typed value is erased */
+	FQuat CursorRotation = FQuat::Identity;
 };
 
 class FScaleMode : public FBlenderToolMode
 {
 public:
 
-	FScaleMode(FEditorViewportClient* InViewportClient, const FText& InOperationName)
-		:FBlenderToolMode(InViewportClient, InOperationName)
+	FScaleMode(FEditorViewportClient* InViewportClient, const FText& InOperationName, const TArray<AActor*>& InActors = TArray<AActor*>())
+		:FBlenderToolMode(InViewportClient, InOperationName, InActors)
 	{
 		FScaleMode::ToolBegin();
 	}
@@ -224,10 +645,25 @@ public:
 	virtual void ToolUpdate() override;
 	virtual void ToolClose(bool Success) override;
 
-	virtual void DrawHUD(FEditorViewportClient* ViewportClient, FViewport* Viewport, const FSceneView* View, FCanvas* Canvas) override;
+	virtual void SetAxisLock(const EToolAxisLock& InAxisToLock, bool bDualAxis) override;
+
+	bool IsIncrementSnapping() const { return GetInputState().bCtrlDown; }
+
+protected:
+	virtual void ApplyNumericInput(float InValue) override;
+	virtual void ReanchorCursor() override;
+	virtual void BuildOverlayState(FToolOverlayState& OutState) const override;
+	virtual FString GetReadout() const override;
 
 private:
+
+	FVector GetScaleAxis() const;
 	
+	EScaleKernel ActiveKernel = EScaleKernel::Uniform;
 	float StartDistance;
+
+	/** Scale multiplier since the operation started, before snapping */
+	float AccumulatedScale = 1.f;
+	float LastFrameCursorScale = 1.f;
 	FIntPoint ActorScreenPosition;
 };
\ No newline at end of file
@@ -0,0 +1,44 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "EditorSubsystem.h"
+#include "BlenderViewportControls_TransformSubsystem.generated.h"
+
+enum class EToolPivotMode : uint8;
+struct FGroupTransform;
+
+/**
+* Batched transforms for scripts and editor utilities. Every call runs on the same group kernels and write back as the interactive tools,
+* inside a single transaction. Actors attached to another actor in the array follow their parent and are not transformed again.
+*/
+UCLASS()
+class BLENDERVIEWPORTCONTROLS_API UBlenderTransformSubsystem : public UEditorSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Moves all actors by Delta */
+	UFUNCTION(BlueprintCallable, Category = "BlenderViewportControls|Transform")
+	void TranslateActors(const TArray<AActor*>& Actors, FVector Delta);
+
+	/** 
+	* Rotates all actors by Rotation around Pivot, Rotation is in world space. With bIndividualOrigins every actor rotates by the same world space rotation
+	* around its own origin and the pivot is ignored, the order of Actors doesn't matter.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "BlenderViewportControls|Transform")
+	void RotateActors(const TArray<AActor*>& Actors, FRotator Rotation, FVector Pivot, bool bIndividualOrigins = false);
+
+	/** Scales all actors by Scale around Pivot. With bIndividualOrigins every actor scales around its own origin and the pivot is ignored */
+	UFUNCTION(BlueprintCallable, Category = "BlenderViewportControls|Transform")
+	void ScaleActors(const TArray<AActor*>& Actors, FVector Scale, FVector Pivot, bool bIndividualOrigins = false);
+
+	/** Average location of the actors, the pivot the interactive tools use */
+	UFUNCTION(BlueprintPure, Category = "BlenderViewportControls|Transform")
+	FVector GetAverageLocation(const TArray<AActor*>& Actors) const;
+
+private:
+	/** Sets up a group for Actors around InPivot, runs InOperation on it and commits the result in one transaction */
+	void RunOperation(const TArray<AActor*>& Actors, const FVector& InPivot, EToolPivotMode InPivotMode, const FText& InOperationName, TFunctionRef<void(FGroupTransform&)> InOperation);
+};